@@ -0,0 +1,42 @@
+/* Xilinx MicroBlaze-specific support for 32-bit ELF
+
+   Copyright (C) 2025 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+   Boston, MA 02110-1301, USA.  */
+
+/* Options passed from the linker emulation to the backend.  */
+
+struct microblaze_elf_params
+{
+  /* Bind PLT entries lazily through a resolver stub in PLT0, instead
+     of having the dynamic linker resolve every JUMP_SLOT at load time
+     (DF_BIND_NOW).  */
+  bool lazy_plt;
+
+  /* If non-NULL, write a line per relaxed input section and a summary
+     of the relaxation passes here once the link is complete.  */
+  FILE *relax_stats;
+};
+
+/* Set the options of the link INFO describes.  The backend keeps its
+   per-link state in the link hash table, which is freed with it, so a
+   process may run any number of links in turn; the options must be
+   set again for each one.  */
+
+extern void microblaze_elf_set_params
+  (struct bfd_link_info *, const struct microblaze_elf_params *);
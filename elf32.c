@@ -24,22 +24,23 @@
 #include "bfd.h"
 #include "bfdlink.h"
 #include "libbfd.h"
+#include "libiberty.h"
 #include "elf-bfd.h"
 #include "elf/microblaze.h"
+#include "elf32-microblaze.h"
 #include <assert.h>
+#include <time.h>
 
 #define	USE_RELA	/* Only USE_REL is actually significant, but this is
 			   here are a reminder...  */
 #define INST_WORD_SIZE 4
 
-static int ro_small_data_pointer = 0;
-static int rw_small_data_pointer = 0;
+/* The howto for each reloc, indexed by type.  */
 
-static reloc_howto_type * microblaze_elf_howto_table [(int) R_MICROBLAZE_max];
-
-static reloc_howto_type microblaze_elf_howto_raw[] =
+static const reloc_howto_type microblaze_elf_howto_table[] =
 {
    /* This reloc does nothing.  */
+   [R_MICROBLAZE_NONE] =
    HOWTO (R_MICROBLAZE_NONE,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  0,			/* Size.  */
@@ -55,6 +56,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* A standard 32 bit relocation.  */
+   [R_MICROBLAZE_32] =
    HOWTO (R_MICROBLAZE_32,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -70,6 +72,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* A standard PCREL 32 bit relocation.  */
+   [R_MICROBLAZE_32_PCREL] =
    HOWTO (R_MICROBLAZE_32_PCREL,/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -85,6 +88,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /* A 64 bit PCREL relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_64_PCREL] =
    HOWTO (R_MICROBLAZE_64_PCREL,/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -100,6 +104,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /* The low half of a PCREL 32 bit relocation.  */
+   [R_MICROBLAZE_32_PCREL_LO] =
    HOWTO (R_MICROBLAZE_32_PCREL_LO,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -115,6 +120,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /* A 64 bit relocation.  Table entry not really used.  */
+   [R_MICROBLAZE_64] =
    HOWTO (R_MICROBLAZE_64,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -130,6 +136,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* The low half of a 32 bit relocation.  */
+   [R_MICROBLAZE_32_LO] =
    HOWTO (R_MICROBLAZE_32_LO,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -145,6 +152,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* Read-only small data section relocation.  */
+   [R_MICROBLAZE_SRO32] =
    HOWTO (R_MICROBLAZE_SRO32,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -160,6 +168,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* Read-write small data area relocation.  */
+   [R_MICROBLAZE_SRW32] =
    HOWTO (R_MICROBLAZE_SRW32,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -175,6 +184,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* This reloc does nothing.	Used for relaxation.  */
+   [R_MICROBLAZE_32_NONE] =
    HOWTO (R_MICROBLAZE_32_NONE,	/* Type.  */
 	0,			/* Rightshift.  */
 	2,			/* Size (0 = byte, 1 = short, 2 = long).  */
@@ -190,6 +200,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	false),		/* PC relative offset?  */
 
    /* This reloc does nothing.	Used for relaxation.  */
+   [R_MICROBLAZE_64_NONE] =
    HOWTO (R_MICROBLAZE_64_NONE,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  0,			/* Size.  */
@@ -205,6 +216,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* Symbol Op Symbol relocation.  */
+   [R_MICROBLAZE_32_SYM_OP_SYM] =
    HOWTO (R_MICROBLAZE_32_SYM_OP_SYM,		/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -220,6 +232,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* GNU extension to record C++ vtable hierarchy.  */
+   [R_MICROBLAZE_GNU_VTINHERIT] =
    HOWTO (R_MICROBLAZE_GNU_VTINHERIT, /* Type.  */
 	  0,			 /* Rightshift.  */
 	  4,			 /* Size.  */
@@ -235,6 +248,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		 /* PC relative offset?  */
 
    /* GNU extension to record C++ vtable member usage.  */
+   [R_MICROBLAZE_GNU_VTENTRY] =
    HOWTO (R_MICROBLAZE_GNU_VTENTRY,   /* Type.  */
 	  0,			 /* Rightshift.  */
 	  4,			 /* Size.  */
@@ -250,6 +264,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		 /* PC relative offset?  */
 
    /* A 64 bit GOTPC relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_GOTPC_64] =
    HOWTO (R_MICROBLAZE_GOTPC_64,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -265,6 +280,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
      /* A 64 bit TEXTPCREL relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_TEXTPCREL_64] =
    HOWTO (R_MICROBLAZE_TEXTPCREL_64,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -280,6 +296,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /* A 64 bit GOT relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_GOT_64] =
    HOWTO (R_MICROBLAZE_GOT_64,  /* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -295,6 +312,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
     /* A 64 bit TEXTREL relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_TEXTREL_64] =
    HOWTO (R_MICROBLAZE_TEXTREL_64,  /* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -309,7 +327,24 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  0x0000ffff,		/* Dest Mask.  */
 	  false),		/* PC relative offset?  */
 
+   /* The low half of a 32 bit TEXTREL relocation.  */
+   [R_MICROBLAZE_TEXTREL_32_LO] =
+   HOWTO (R_MICROBLAZE_TEXTREL_32_LO,	/* Type.  */
+	  0,			/* Rightshift.  */
+	  4,			/* Size.  */
+	  16,			/* Bitsize.  */
+	  false,		/* PC_relative.  */
+	  0,			/* Bitpos.  */
+	  complain_overflow_signed, /* Complain on overflow.  */
+	  bfd_elf_generic_reloc,/* Special Function.  */
+	  "R_MICROBLAZE_TEXTREL_32_LO", /* Name.  */
+	  false,		/* Partial Inplace.  */
+	  0,			/* Source Mask.  */
+	  0x0000ffff,		/* Dest Mask.  */
+	  false),		/* PC relative offset?  */
+
    /* A 64 bit PLT relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_PLT_64] =
    HOWTO (R_MICROBLAZE_PLT_64,  /* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -325,6 +360,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /*  Table-entry not really used.  */
+   [R_MICROBLAZE_REL] =
    HOWTO (R_MICROBLAZE_REL,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -340,6 +376,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /*  Table-entry not really used.  */
+   [R_MICROBLAZE_JUMP_SLOT] =
    HOWTO (R_MICROBLAZE_JUMP_SLOT,/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -355,6 +392,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /*  Table-entry not really used.  */
+   [R_MICROBLAZE_GLOB_DAT] =
    HOWTO (R_MICROBLAZE_GLOB_DAT,/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -370,6 +408,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  true),		/* PC relative offset?  */
 
    /* A 64 bit GOT relative relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_GOTOFF_64] =
    HOWTO (R_MICROBLAZE_GOTOFF_64,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -385,6 +424,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* A 32 bit GOT relative relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_GOTOFF_32] =
    HOWTO (R_MICROBLAZE_GOTOFF_32,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -400,6 +440,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* COPY relocation.  Table-entry not really used.  */
+   [R_MICROBLAZE_COPY] =
    HOWTO (R_MICROBLAZE_COPY,	/* Type.  */
 	  0,			/* Rightshift.  */
 	  4,			/* Size.  */
@@ -415,6 +456,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	  false),		/* PC relative offset?  */
 
    /* Marker relocs for TLS.  */
+   [R_MICROBLAZE_TLS] =
    HOWTO (R_MICROBLAZE_TLS,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -429,6 +471,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	 0x0000ffff,			/* dst_mask */
 	 false),		/* pcrel_offset */
 
+   [R_MICROBLAZE_TLSGD] =
    HOWTO (R_MICROBLAZE_TLSGD,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -443,6 +486,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 	 0x0000ffff,			/* dst_mask */
 	 false),		/* pcrel_offset */
 
+   [R_MICROBLAZE_TLSLD] =
    HOWTO (R_MICROBLAZE_TLSLD,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -459,6 +503,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 
    /* Computes the load module index of the load module that contains the
       definition of its TLS sym.  */
+   [R_MICROBLAZE_TLSDTPMOD32] =
    HOWTO (R_MICROBLAZE_TLSDTPMOD32,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -476,6 +521,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
    /* Computes a dtv-relative displacement, the difference between the value
       of sym+add and the base address of the thread-local storage block that
       contains the definition of sym, minus 0x8000.  Used for initializing GOT */
+   [R_MICROBLAZE_TLSDTPREL32] =
    HOWTO (R_MICROBLAZE_TLSDTPREL32,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -493,6 +539,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
    /* Computes a dtv-relative displacement, the difference between the value
       of sym+add and the base address of the thread-local storage block that
       contains the definition of sym, minus 0x8000.  */
+   [R_MICROBLAZE_TLSDTPREL64] =
    HOWTO (R_MICROBLAZE_TLSDTPREL64,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -509,6 +556,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 
    /* Computes a tp-relative displacement, the difference between the value of
       sym+add and the value of the thread pointer (r13).  */
+   [R_MICROBLAZE_TLSGOTTPREL32] =
    HOWTO (R_MICROBLAZE_TLSGOTTPREL32,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -525,6 +573,7 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 
    /* Computes a tp-relative displacement, the difference between the value of
       sym+add and the value of the thread pointer (r13).  */
+   [R_MICROBLAZE_TLSTPREL32] =
    HOWTO (R_MICROBLAZE_TLSTPREL32,
 	 0,			/* rightshift */
 	 4,			/* size */
@@ -545,20 +594,10 @@ static reloc_howto_type microblaze_elf_howto_raw[] =
 #define NUM_ELEM(a) (sizeof (a) / sizeof (a)[0])
 #endif
 
-/* Initialize the microblaze_elf_howto_table, so that linear accesses can be done.  */
-
-static void
-microblaze_elf_howto_init (void)
-{
-  unsigned int i;
-
-  for (i = NUM_ELEM (microblaze_elf_howto_raw); i--;)
-    {
-      unsigned int type = microblaze_elf_howto_raw[i].type;
-      BFD_ASSERT (type < NUM_ELEM (microblaze_elf_howto_table));
-      microblaze_elf_howto_table [type] = & microblaze_elf_howto_raw [i];
-    }
-}
+/* Fail to compile unless the table has an entry for every type up to
+   R_MICROBLAZE_max.  */
+typedef char microblaze_elf_howto_table_size_check
+  [NUM_ELEM (microblaze_elf_howto_table) == R_MICROBLAZE_max ? 1 : -1];
 
 static enum elf_microblaze_reloc_type
 map_bfd_reloc_to_microblaze(bfd_reloc_code_real_type code)
@@ -629,13 +668,6 @@ map_bfd_reloc_to_microblaze(bfd_reloc_code_real_type code)
     }
 }
 
-static void
-ensure_howto_table_initialized(void)
-{
-  if (!microblaze_elf_howto_table[R_MICROBLAZE_32])
-    microblaze_elf_howto_init();
-}
-
 static reloc_howto_type *
 microblaze_elf_reloc_type_lookup(bfd * abfd ATTRIBUTE_UNUSED,
                                  bfd_reloc_code_real_type code)
@@ -645,27 +677,75 @@ microblaze_elf_reloc_type_lookup(bfd * abfd ATTRIBUTE_UNUSED,
   if (microblaze_reloc == R_MICROBLAZE_NONE && code != BFD_RELOC_NONE)
     return (reloc_howto_type *) NULL;
     
-  ensure_howto_table_initialized();
-  
-  return microblaze_elf_howto_table[(int) microblaze_reloc];
+  return &microblaze_elf_howto_table[(int) microblaze_reloc];
 };
 
+/* The reloc types ordered by strcasecmp of their names, so that
+   microblaze_elf_reloc_name_lookup can binary search them.  New relocs
+   must be inserted in order.  */
+
+static const unsigned char microblaze_elf_howto_by_name[] =
+  {
+    R_MICROBLAZE_32,
+    R_MICROBLAZE_32_LO,
+    R_MICROBLAZE_32_NONE,
+    R_MICROBLAZE_32_PCREL,
+    R_MICROBLAZE_32_PCREL_LO,
+    R_MICROBLAZE_32_SYM_OP_SYM,
+    R_MICROBLAZE_64,
+    R_MICROBLAZE_64_NONE,
+    R_MICROBLAZE_64_PCREL,
+    R_MICROBLAZE_COPY,
+    R_MICROBLAZE_GLOB_DAT,
+    R_MICROBLAZE_GNU_VTENTRY,
+    R_MICROBLAZE_GNU_VTINHERIT,
+    R_MICROBLAZE_GOT_64,
+    R_MICROBLAZE_GOTOFF_32,
+    R_MICROBLAZE_GOTOFF_64,
+    R_MICROBLAZE_GOTPC_64,
+    R_MICROBLAZE_JUMP_SLOT,
+    R_MICROBLAZE_NONE,
+    R_MICROBLAZE_PLT_64,
+    R_MICROBLAZE_REL,
+    R_MICROBLAZE_SRO32,
+    R_MICROBLAZE_SRW32,
+    R_MICROBLAZE_TEXTPCREL_64,
+    R_MICROBLAZE_TEXTREL_32_LO,
+    R_MICROBLAZE_TEXTREL_64,
+    R_MICROBLAZE_TLS,
+    R_MICROBLAZE_TLSDTPMOD32,
+    R_MICROBLAZE_TLSDTPREL32,
+    R_MICROBLAZE_TLSDTPREL64,
+    R_MICROBLAZE_TLSGD,
+    R_MICROBLAZE_TLSGOTTPREL32,
+    R_MICROBLAZE_TLSLD,
+    R_MICROBLAZE_TLSTPREL32,
+  };
+
+typedef char microblaze_elf_howto_by_name_size_check
+  [NUM_ELEM (microblaze_elf_howto_by_name) == R_MICROBLAZE_max ? 1 : -1];
+
+static int
+compare_reloc_name (const void *key, const void *elt)
+{
+  const unsigned char *type = (const unsigned char *) elt;
+
+  return strcasecmp ((const char *) key, microblaze_elf_howto_table[*type].name);
+}
+
 static reloc_howto_type *
 microblaze_elf_reloc_name_lookup (bfd *abfd ATTRIBUTE_UNUSED,
 				  const char *r_name)
 {
-  unsigned int i;
+  const unsigned char *type;
 
-  for (i = 0; i < NUM_ELEM (microblaze_elf_howto_raw); i++)
-    {
-      if (microblaze_elf_howto_raw[i].name == NULL)
-        continue;
-      
-      if (strcasecmp (microblaze_elf_howto_raw[i].name, r_name) == 0)
-        return &microblaze_elf_howto_raw[i];
-    }
+  type = bsearch (r_name, microblaze_elf_howto_by_name,
+		  NUM_ELEM (microblaze_elf_howto_by_name),
+		  sizeof (microblaze_elf_howto_by_name[0]), compare_reloc_name);
+  if (type == NULL)
+    return NULL;
 
-  return NULL;
+  return &microblaze_elf_howto_table[*type];
 }
 
 /* Set the howto pointer for a RCE ELF reloc.  */
@@ -675,9 +755,6 @@ microblaze_elf_info_to_howto (bfd * abfd,
 			      arelent * cache_ptr,
 			      Elf_Internal_Rela * dst)
 {
-  if (!microblaze_elf_howto_table [R_MICROBLAZE_32])
-    microblaze_elf_howto_init ();
-
   unsigned int r_type = ELF32_R_TYPE (dst->r_info);
   
   if (r_type >= R_MICROBLAZE_max)
@@ -688,7 +765,10 @@ microblaze_elf_info_to_howto (bfd * abfd,
       return false;
     }
 
-  cache_ptr->howto = microblaze_elf_howto_table [r_type];
+  /* An entry missed out of the table, or put under the wrong type,
+     would be zero or another reloc's howto.  */
+  BFD_ASSERT (microblaze_elf_howto_table[r_type].type == r_type);
+  cache_ptr->howto = &microblaze_elf_howto_table [r_type];
   return true;
 }
 
@@ -702,6 +782,30 @@ struct relax_table
 
   /* Number of bytes to be deleted.  */
   size_t size;
+
+  /* Number of bytes deleted by all earlier entries.  */
+  size_t cum_size;
+};
+
+/* What relaxation did to one section, or to the whole link.  Times are
+   elapsed wall clock time in microseconds, see microblaze_relax_clock,
+   and are only measured when a report has been asked for.  */
+struct microblaze_relax_stats
+{
+  /* Calls of relax_section that examined the section, and rounds of
+     scanning within them.  */
+  unsigned long calls;
+  unsigned long rounds;
+  /* imm words deleted, and the bytes that saved.  */
+  unsigned long imm_deleted;
+  unsigned long bytes_saved;
+  /* Relocs narrowed by rewrite_relocation_type.  */
+  unsigned long relocs_rewritten;
+  /* Relocs in other sections adjusted for the deleted bytes.  */
+  unsigned long other_relocs_patched;
+  /* Time spent looking for imm words to delete, and deleting them.  */
+  long scan_time;
+  long delete_time;
 };
 
 struct _microblaze_elf_section_data
@@ -711,11 +815,157 @@ struct _microblaze_elf_section_data
   size_t relax_count;
   /* Relaxation table.  */
   struct relax_table *relax;
+  /* Relocs in this section that relaxation could still shorten, counted
+     by check_relocs and decremented as they are rewritten.  Only valid
+     when RELAX_CENSUS is set.  */
+  size_t relax_candidates;
+  bool relax_census;
+  /* Value of the link's relax_generation when this section was last
+     scanned, before any bytes that scan deleted, or zero if it has never
+     been relaxed.  */
+  unsigned int relax_generation;
+  /* Number of relative relocs in this section packed into .relr.dyn.  */
+  bfd_size_type relr_count;
+  /* Relaxation statistics for the current link.  */
+  struct microblaze_relax_stats relax_stats;
+  /* Set when relaxation read this section's contents itself and left
+     them cached on this_hdr.contents, so that they are its to release.  */
+  bool relax_contents_cached;
+  /* Set when relaxation has rewritten the relocs cached on this
+     section, which then no longer match the file.  */
+  bool relax_relocs_cached;
+  /* The section's size before relaxation first shrank it, or zero.  */
+  bfd_size_type relax_orig_size;
+};
+
+/* Dynamic relocs against a symbol from one input section.  Each set is
+   given its own range of slots in the section's dynamic reloc section
+   when the dynamic sections are sized, so relocate_section can output
+   them in any order.  */
+struct elf32_mb_dyn_relocs
+{
+  struct elf_dyn_relocs root;
+  /* The first slot of the range, and how many relocs have been output
+     into it.  */
+  bfd_size_type rel_index;
+  bfd_size_type emitted;
 };
 
 #define microblaze_elf_section_data(sec) \
   ((struct _microblaze_elf_section_data *) elf_section_data (sec))
 
+/* A reloc in another section of the same object, identified by its
+   section and its index in that section's internal relocs.  */
+struct microblaze_sec_ref
+{
+  asection *sec;
+  size_t reloc_index;
+};
+
+/* Byte order accessors for instruction words.  The relocation and
+   relaxation code reads the byte order once, from an object's tdata or
+   the link hash table, and passes it down, so these expand to plain
+   byte moves where the bfd_get/bfd_put macros would call through the
+   bfd's target vector for every access.  Loops over many words select
+   a copy specialized for each byte order, as apply_imm_patches_be and
+   apply_imm_patches_le do, so they do not test it for each word.  */
+
+static inline bfd_vma
+microblaze_get_insn (bool big_endian, const bfd_byte *p)
+{
+  if (big_endian)
+    return (((bfd_vma) p[0] << 24) | ((bfd_vma) p[1] << 16)
+	    | ((bfd_vma) p[2] << 8) | p[3]);
+  return (((bfd_vma) p[3] << 24) | ((bfd_vma) p[2] << 16)
+	  | ((bfd_vma) p[1] << 8) | p[0]);
+}
+
+static inline void
+microblaze_put_insn (bool big_endian, bfd_vma value, bfd_byte *p)
+{
+  if (big_endian)
+    {
+      p[0] = value >> 24;
+      p[1] = value >> 16;
+      p[2] = value >> 8;
+      p[3] = value;
+    }
+  else
+    {
+      p[0] = value;
+      p[1] = value >> 8;
+      p[2] = value >> 16;
+      p[3] = value >> 24;
+    }
+}
+
+/* Store the low 16 bits of VALUE in the immediate field of the
+   instruction word at P, which is the word's second half when it is
+   big-endian and its first half otherwise.  */
+
+static inline void
+microblaze_put_imm (bool big_endian, bfd_vma value, bfd_byte *p)
+{
+  if (big_endian)
+    {
+      p[2] = value >> 8;
+      p[3] = value;
+    }
+  else
+    {
+      p[0] = value;
+      p[1] = value >> 8;
+    }
+}
+
+/* MicroBlaze ELF object data.  */
+
+struct elf32_mb_obj_tdata
+{
+  struct elf_obj_tdata root;
+
+  /* Reverse index, built the first time a section of this object is
+     relaxed, from a section's ELF index to the relocs that refer to it
+     through its section symbol.  The refs for section N are
+     sec_refs[sec_ref_start[N]] up to sec_refs[sec_ref_start[N + 1]].  */
+  size_t *sec_ref_start;
+  struct microblaze_sec_ref *sec_refs;
+
+  /* R_MICROBLAZE_32_SYM_OP_SYM relocs, which are adjusted whichever
+     section shrinks.  */
+  struct microblaze_sec_ref *sym_op_sym_refs;
+  size_t sym_op_sym_count;
+
+  /* For each local symbol with a GOT entry, the first .rela.got slot
+     reserved for it, or RELR_REL_INDEX if its relative reloc is packed
+     into .relr.dyn instead.  */
+  bfd_size_type *local_got_rel_index;
+
+  /* Set when relaxation read the local symbols itself and left them,
+     adjusted for the bytes it deleted, cached on the symtab header.  */
+  bool relax_syms_cached;
+
+  /* Whether this object is big-endian.  */
+  bool big_endian;
+};
+
+/* The dynamic reloc slot of a GOT entry whose relative reloc goes to
+   .relr.dyn, which has no slots.  */
+#define RELR_REL_INDEX ((bfd_size_type) -1)
+
+#define elf32_mb_tdata(abfd) \
+  ((struct elf32_mb_obj_tdata *) (abfd)->tdata.any)
+
+static bool
+microblaze_elf_mkobject (bfd *abfd)
+{
+  if (!bfd_elf_allocate_object (abfd, sizeof (struct elf32_mb_obj_tdata)))
+    return false;
+
+  elf32_mb_tdata (abfd)->big_endian = bfd_big_endian (abfd);
+  return true;
+}
+
 static bool
 microblaze_elf_new_section_hook (bfd *abfd, asection *sec)
 {
@@ -755,19 +1005,26 @@ struct elf32_mb_link_hash_entry
   struct elf_link_hash_entry elf;
 
   /* TLS Reference Types for the symbol; Updated by check_relocs */
-#define TLS_GD     1  /* GD reloc. */
-#define TLS_LD     2  /* LD reloc. */
-#define TLS_TPREL  4  /* TPREL reloc, => IE. */
-#define TLS_DTPREL 8  /* DTPREL reloc, => LD. */
-#define TLS_TLS    16 /* Any TLS reloc.  */
+#define TLS_TLS    1  /* Any TLS reloc.  */
+#define TLS_GD     2  /* GD reloc. */
+#define TLS_LD     4  /* LD reloc. */
+#define TLS_TPREL  8  /* TPREL reloc, => IE. */
+#define TLS_TPREL_NORELAX 16	/* An IE access that cannot become LE.  */
   unsigned char tls_mask;
 
+  /* Number of GOT_64 loads of the symbol that can be rewritten to
+     GOTOFF addressing if it turns out to bind locally.  */
+  bfd_signed_vma gotoff_refcount;
+
+  /* The first dynamic reloc slot reserved for the GOT entry, as for
+     local_got_rel_index.  */
+  bfd_size_type got_rel_index;
+
 };
 
-#define IS_TLS_GD(x)     (x == (TLS_TLS | TLS_GD))
-#define IS_TLS_LD(x)     (x == (TLS_TLS | TLS_LD))
-#define IS_TLS_DTPREL(x) (x == (TLS_TLS | TLS_DTPREL))
-#define IS_TLS_NONE(x)   (x == 0)
+#define IS_TLS_LD(x) ((x) & TLS_LD)
+#define IS_TLS_GD(x) ((x) & TLS_GD)
+#define IS_TLS_TPREL(x) ((x) & TLS_TPREL)
 
 #define elf32_mb_hash_entry(ent) ((struct elf32_mb_link_hash_entry *)(ent))
 
@@ -782,6 +1039,45 @@ struct elf32_mb_link_hash_table
     bfd_signed_vma refcount;
     bfd_vma offset;
   } tlsld_got;
+  bfd_size_type tlsld_got_rel_index;
+
+  /* Bumped whenever relaxation deletes bytes from any section.  A section
+     whose recorded generation still matches has no target that moved
+     since it was last scanned, so it need not be scanned again.  */
+  unsigned int relax_generation;
+
+  /* Calls of relax_section, and those skipped because the section was
+     already at a fixpoint.  */
+  unsigned long relax_calls;
+  unsigned long relax_skipped;
+
+  /* Relax table shared by every call of relax_section, which only ever
+     grows, its size in entries, and how often it had to grow.  */
+  struct relax_table *relax_buf;
+  size_t relax_buf_alloc;
+  unsigned long relax_buf_grows;
+
+  /* Options set by the linker emulation.  */
+  struct microblaze_elf_params params;
+
+  /* Whether the output is big-endian.  */
+  bool big_endian;
+
+  /* Relative relocs packed into .relr.dyn: an upper bound on their
+     number, their output addresses as collected for the current layout,
+     how many there are, and how many times the layout was redone to
+     fit the encoding.  */
+  bfd_size_type relr_alloc;
+  bfd_vma *relr;
+  bfd_size_type relr_count;
+  unsigned int relr_layout_passes;
+
+  /* Values of the read-only and read-write small data anchors, looked
+     up by the first relocate_section call of the final link.  Zero if
+     the anchor is not defined.  */
+  bool sdp_resolved;
+  bfd_vma ro_small_data_pointer;
+  bfd_vma rw_small_data_pointer;
 };
 
 /* Nonzero if this section has TLS related relocations.  */
@@ -811,6 +1107,8 @@ initialize_mb_link_hash_entry(struct bfd_hash_entry *entry)
   struct elf32_mb_link_hash_entry *eh;
   eh = (struct elf32_mb_link_hash_entry *) entry;
   eh->tls_mask = 0;
+  eh->gotoff_refcount = 0;
+  eh->got_rel_index = 0;
 }
 
 static struct bfd_hash_entry *
@@ -830,6 +1128,23 @@ link_hash_newfunc(struct bfd_hash_entry *entry,
   return entry;
 }
 
+/* Free the backend data of a mb ELF linker hash table along with the
+   table itself.  Entries are allocated from the table's objalloc, so
+   only side buffers need freeing here.  */
+
+static void
+microblaze_elf_link_hash_table_free (bfd *obfd)
+{
+  struct elf32_mb_link_hash_table *htab
+    = (struct elf32_mb_link_hash_table *) obfd->link.hash;
+
+  free (htab->relr);
+  htab->relr = NULL;
+  free (htab->relax_buf);
+  htab->relax_buf = NULL;
+  _bfd_elf_link_hash_table_free (obfd);
+}
+
 /* Create a mb ELF linker hash table.  */
 
 static struct bfd_link_hash_table *
@@ -849,8 +1164,24 @@ microblaze_elf_link_hash_table_create (bfd *abfd)
       return NULL;
     }
 
+  ret->elf.root.hash_table_free = microblaze_elf_link_hash_table_free;
+  ret->big_endian = bfd_big_endian (abfd);
+  ret->relax_generation = 1;
+
   return &ret->elf.root;
 }
+
+/* Record the linker emulation's options for this link.  */
+
+void
+microblaze_elf_set_params (struct bfd_link_info *info,
+			   const struct microblaze_elf_params *params)
+{
+  struct elf32_mb_link_hash_table *htab = elf32_mb_hash_table (info);
+
+  if (htab != NULL)
+    htab->params = *params;
+}
 
 /* Set the values of the small data pointers.  */
 
@@ -875,10 +1206,17 @@ set_small_data_pointer(struct bfd_link_info *info,
 }
 
 static void
-microblaze_elf_final_sdp(struct bfd_link_info *info)
+microblaze_elf_final_sdp(struct bfd_link_info *info,
+                         struct elf32_mb_link_hash_table *htab)
 {
-  set_small_data_pointer(info, RO_SDA_ANCHOR_NAME, &ro_small_data_pointer);
-  set_small_data_pointer(info, RW_SDA_ANCHOR_NAME, &rw_small_data_pointer);
+  if (htab->sdp_resolved)
+    return;
+
+  htab->ro_small_data_pointer = 0;
+  htab->rw_small_data_pointer = 0;
+  set_small_data_pointer(info, RO_SDA_ANCHOR_NAME, &htab->ro_small_data_pointer);
+  set_small_data_pointer(info, RW_SDA_ANCHOR_NAME, &htab->rw_small_data_pointer);
+  htab->sdp_resolved = true;
 }
 
 static bfd_vma
@@ -895,6 +1233,22 @@ dtprel_base (struct bfd_link_info *info)
 /* The size of the thread control block.  */
 #define TCB_SIZE	8
 
+/* The thread pointer (r21) addresses the TCB; the TLS block of the
+   executable follows it at the alignment of the TLS segment.  */
+
+static bfd_vma
+tprel_base (struct bfd_link_info *info)
+{
+  struct elf_link_hash_table *hash_table = elf_hash_table (info);
+
+  if (hash_table->tls_sec == NULL)
+    return 0;
+
+  return (hash_table->tls_sec->vma
+	  - align_power ((bfd_vma) TCB_SIZE,
+			 hash_table->tls_sec->alignment_power));
+}
+
 /* Output a simple dynamic relocation into SRELOC.  */
 
 static void
@@ -916,6 +1270,56 @@ microblaze_elf_output_dynamic_relocation (bfd *output_bfd,
 	      (sreloc->contents + reloc_index * sizeof (Elf32_External_Rela)));
 }
 
+/* Relative relocs go to .relr.dyn when the link asks for DT_RELR and
+   the dynamic sections provide one.  */
+
+static bool
+microblaze_elf_use_relr (struct bfd_link_info *info,
+			 struct elf32_mb_link_hash_table *htab)
+{
+  return (info->enable_dt_relr
+	  && bfd_link_pic (info)
+	  && htab->elf.srelrdyn != NULL);
+}
+
+/* Return true if an R_MICROBLAZE_32 reloc against a local symbol at
+   OFFSET in SEC becomes a .relr.dyn entry.  RELR only describes
+   word-aligned addresses, and text relocations stay in .rela.dyn.  */
+
+static bool
+microblaze_elf_relr_reloc_p (struct bfd_link_info *info,
+			     struct elf32_mb_link_hash_table *htab,
+			     asection *sec, unsigned int r_type,
+			     bfd_vma offset)
+{
+  return (microblaze_elf_use_relr (info, htab)
+	  && r_type == R_MICROBLAZE_32
+	  && (sec->flags & SEC_READONLY) == 0
+	  && sec->alignment_power >= 2
+	  && (offset & 3) == 0);
+}
+
+/* Output a relative reloc into slot REL_INDEX for the GOT word at output
+   address OFFSET, LOC in the GOT contents, whose value is VALUE.  With
+   RELR the word only needs its value; its address is collected for
+   .relr.dyn by microblaze_elf_size_relative_relocs.  */
+
+static void
+microblaze_elf_output_relative_reloc (bfd *output_bfd,
+				      struct bfd_link_info *info,
+				      struct elf32_mb_link_hash_table *htab,
+				      asection *sreloc, bfd_size_type rel_index,
+				      bfd_vma offset, bfd_vma value,
+				      bfd_byte *loc)
+{
+  if (microblaze_elf_use_relr (info, htab))
+    bfd_put_32 (output_bfd, value, loc);
+  else
+    microblaze_elf_output_dynamic_relocation (output_bfd, sreloc, rel_index,
+					      0, R_MICROBLAZE_REL, offset,
+					      value);
+}
+
 /* This code is taken from elf32-m32r.c
    There is some attempt to make this function usable for many architectures,
    both USE_REL and USE_RELA ['twould be nice if such a critter existed],
@@ -952,11 +1356,34 @@ microblaze_elf_output_dynamic_relocation (bfd *output_bfd,
 
 #define MASK_16BIT 0xffff
 #define INST_WORD_SIZE 4
-#define TLS_TLS 1
-#define TLS_GD 2
-#define TLS_LD 4
-#define IS_TLS_LD(x) ((x) & TLS_LD)
-#define IS_TLS_GD(x) ((x) & TLS_GD)
+
+/* relocate_section marks the parts of a GOT entry it has initialized
+   in the low bits of the entry's offset, which is word aligned.  */
+#define GOT_DONE_ENTRY 1	/* The GD, LD or plain part.  */
+#define GOT_DONE_TPREL 2	/* The IE part.  */
+#define GOT_DONE_MASK 3
+
+/* Instruction fields and opcodes used when rewriting TLS sequences.  */
+#define INST_OPCODE_MASK	0xfc000000
+#define INST_RD_MASK		0x03e00000
+#define INST_RA_MASK		0x001f0000
+#define INST_RD(r)		((bfd_vma) (r) << 21)
+#define INST_RA(r)		((bfd_vma) (r) << 16)
+#define INST_RB(r)		((bfd_vma) (r) << 11)
+#define INST_GET_RD(i)		(((i) & INST_RD_MASK) >> 21)
+#define INST_GET_RA(i)		(((i) & INST_RA_MASK) >> 16)
+#define INST_IMM		0xb0000000	/* "imm".  */
+#define INST_ADDIK		0x30000000	/* "addik rD,rA,imm".  */
+#define INST_ADDK		0x10000000	/* "addk rD,rA,rB".  */
+#define INST_LWI		0xe8000000	/* "lwi rD,rA,imm".  */
+#define INST_NOP		0x80000000	/* "nop".  */
+#define INST_BRI		0xb8000000	/* Unconditional immediate branch.  */
+#define INST_BRANCH_LINK	0x00040000	/* "l" bit of an "bri".  */
+#define INST_BRANCH_DELAY	0x00100000	/* "d" bit of an "bri".  */
+#define REG_RET			3
+#define REG_ARG1		5
+#define REG_GOT			20
+#define REG_TP			21
 
 static bool
 validate_relocation_type(bfd *input_bfd, int r_type)
@@ -1069,15 +1496,13 @@ process_sro32_relocation(bfd *input_bfd, asection *input_section,
       return false;
     }
     
-  if (ro_small_data_pointer == 0)
-    {
-      microblaze_elf_final_sdp(info);
-      if (ro_small_data_pointer == 0)
-        return false;
-    }
+  bfd_vma sdp = elf32_mb_hash_table(info)->ro_small_data_pointer;
+  
+  if (sdp == 0)
+    return false;
     
   handle_small_data_relocation(input_bfd, input_section, contents, offset,
-                              relocation, addend, ro_small_data_pointer, howto);
+                              relocation, addend, sdp, howto);
   return true;
 }
 
@@ -1100,33 +1525,24 @@ process_srw32_relocation(bfd *input_bfd, asection *input_section,
       return false;
     }
     
-  if (rw_small_data_pointer == 0)
-    {
-      microblaze_elf_final_sdp(info);
-      if (rw_small_data_pointer == 0)
-        return false;
-    }
+  bfd_vma sdp = elf32_mb_hash_table(info)->rw_small_data_pointer;
+  
+  if (sdp == 0)
+    return false;
     
   handle_small_data_relocation(input_bfd, input_section, contents, offset,
-                              relocation, addend, rw_small_data_pointer, howto);
+                              relocation, addend, sdp, howto);
   return true;
 }
 
 static void
-write_64bit_value(bfd *input_bfd, bfd_byte *contents, bfd_vma offset,
-                 bfd_vma value, int endian)
+write_64bit_value(bool big_endian, bfd_byte *contents,
+                 bfd_vma offset, bfd_vma value)
 {
-  bfd_put_16(input_bfd, (value >> 16) & MASK_16BIT, contents + offset + endian);
-  bfd_put_16(input_bfd, value & MASK_16BIT, contents + offset + endian + INST_WORD_SIZE);
-}
+  bfd_byte *loc = contents + offset;
 
-static void
-compute_pc_relative_offset(asection *input_section, bfd_vma *relocation,
-                          bfd_vma offset, bfd_vma addend)
-{
-  *relocation -= (input_section->output_section->vma +
-                 input_section->output_offset + offset + INST_WORD_SIZE);
-  *relocation += addend;
+  microblaze_put_imm(big_endian, (value >> 16) & MASK_16BIT, loc);
+  microblaze_put_imm(big_endian, value & MASK_16BIT, loc + INST_WORD_SIZE);
 }
 
 static bfd_vma *
@@ -1148,6 +1564,20 @@ get_got_offset_pointer(struct elf32_mb_link_hash_table *htab,
   return NULL;
 }
 
+static bfd_size_type
+get_got_rel_index(struct elf32_mb_link_hash_table *htab, bfd *input_bfd,
+                  struct elf_link_hash_entry *h, unsigned long r_symndx,
+                  unsigned int tls_type)
+{
+  if (IS_TLS_LD(tls_type))
+    return htab->tlsld_got_rel_index;
+  else if (h != NULL)
+    return elf32_mb_hash_entry(h)->got_rel_index;
+  else if (elf32_mb_tdata(input_bfd)->local_got_rel_index != NULL)
+    return elf32_mb_tdata(input_bfd)->local_got_rel_index[r_symndx];
+  return 0;
+}
+
 static unsigned long
 get_symbol_index(struct bfd_link_info *info, struct elf_link_hash_entry *h)
 {
@@ -1163,9 +1593,14 @@ get_symbol_index(struct bfd_link_info *info, struct elf_link_hash_entry *h)
   return 0;
 }
 
+/* Initialize the GOT words of an entry at OFF, whose dynamic relocs
+   go in slots from REL_INDEX on.  Each slot is reserved for one word,
+   so initializing an entry again rewrites the same data.  */
+
 static void
 process_tls_module_id(bfd *output_bfd, struct elf32_mb_link_hash_table *htab,
                      struct bfd_link_info *info, bfd_vma off,
+                     bfd_size_type rel_index,
                      unsigned int tls_type, unsigned long indx,
                      bfd_vma static_value, bool need_relocs)
 {
@@ -1178,7 +1613,7 @@ process_tls_module_id(bfd *output_bfd, struct elf32_mb_link_hash_table *htab,
         bfd_put_32(output_bfd, 1, htab->elf.sgot->contents + off);
       else
         microblaze_elf_output_dynamic_relocation(output_bfd, htab->elf.srelgot,
-                                                htab->elf.srelgot->reloc_count++,
+                                                rel_index,
                                                 0, R_MICROBLAZE_TLSDTPMOD32,
                                                 got_offset, 0);
     }
@@ -1188,7 +1623,7 @@ process_tls_module_id(bfd *output_bfd, struct elf32_mb_link_hash_table *htab,
         bfd_put_32(output_bfd, 1, htab->elf.sgot->contents + off);
       else
         microblaze_elf_output_dynamic_relocation(output_bfd, htab->elf.srelgot,
-                                                htab->elf.srelgot->reloc_count++,
+                                                rel_index,
                                                 indx, R_MICROBLAZE_TLSDTPMOD32,
                                                 got_offset, indx ? 0 : static_value);
     }
@@ -1197,40 +1632,48 @@ process_tls_module_id(bfd *output_bfd, struct elf32_mb_link_hash_table *htab,
 static void
 process_tls_offset(bfd *output_bfd, struct elf32_mb_link_hash_table *htab,
                   struct bfd_link_info *info, bfd_vma off2,
+                  bfd_size_type rel_index,
                   unsigned int tls_type, unsigned long indx,
-                  bfd_vma static_value, bool need_relocs, bfd_vma *offp)
+                  bfd_vma static_value, bool need_relocs)
 {
   bfd_vma got_offset = htab->elf.sgot->output_section->vma +
                       htab->elf.sgot->output_offset + off2;
                       
   if (IS_TLS_LD(tls_type))
     {
-      *offp |= 1;
       bfd_put_32(output_bfd, 0, htab->elf.sgot->contents + off2);
     }
   else if (IS_TLS_GD(tls_type))
     {
-      *offp |= 1;
       static_value -= dtprel_base(info);
       if (need_relocs)
         microblaze_elf_output_dynamic_relocation(output_bfd, htab->elf.srelgot,
-                                                htab->elf.srelgot->reloc_count++,
+                                                rel_index,
                                                 indx, R_MICROBLAZE_TLSDTPREL32,
                                                 got_offset, indx ? 0 : static_value);
       else
         bfd_put_32(output_bfd, static_value, htab->elf.sgot->contents + off2);
     }
+  else if (IS_TLS_TPREL(tls_type))
+    {
+      if (need_relocs)
+        microblaze_elf_output_dynamic_relocation(output_bfd, htab->elf.srelgot,
+                                                rel_index,
+                                                indx, R_MICROBLAZE_TLSTPREL32,
+                                                got_offset,
+                                                indx ? 0 : static_value - dtprel_base(info));
+      else
+        bfd_put_32(output_bfd, static_value - tprel_base(info),
+                   htab->elf.sgot->contents + off2);
+    }
   else
     {
       bfd_put_32(output_bfd, static_value, htab->elf.sgot->contents + off2);
       if (bfd_link_pic(info) && !indx)
-        {
-          *offp |= 1;
-          microblaze_elf_output_dynamic_relocation(output_bfd, htab->elf.srelgot,
-                                                  htab->elf.srelgot->reloc_count++,
-                                                  indx, R_MICROBLAZE_REL,
-                                                  got_offset, static_value);
-        }
+        microblaze_elf_output_relative_reloc(output_bfd, info, htab,
+                                            htab->elf.srelgot, rel_index,
+                                            got_offset, static_value,
+                                            htab->elf.sgot->contents + off2);
     }
 }
 
@@ -1259,20 +1702,41 @@ needs_dynamic_relocation(struct bfd_link_info *info,
   return false;
 }
 
-static void
+/* Return the slot in INPUT_SECTION's dynamic reloc section for the next
+   reloc of the set HEAD from INPUT_SECTION, or -1 if late_size_sections
+   reserved no room for it.  */
+
+static bfd_size_type
+next_dyn_reloc_index(struct elf_dyn_relocs *head, asection *input_section)
+{
+  struct elf_dyn_relocs *p;
+
+  for (p = head; p != NULL; p = p->next)
+    {
+      struct elf32_mb_dyn_relocs *mp = (struct elf32_mb_dyn_relocs *) p;
+
+      if (p->sec == input_section && mp->emitted < p->count)
+        return mp->rel_index + mp->emitted++;
+    }
+  return (bfd_size_type) -1;
+}
+
+static bool
 output_dynamic_relocation(bfd *output_bfd, asection *sreloc, asection *input_section,
                          Elf_Internal_Rela *rel, struct elf_link_hash_entry *h,
+                         asection *sym_sec,
                          bfd_vma relocation, bfd_vma addend, int r_type,
                          struct bfd_link_info *info)
 {
   Elf_Internal_Rela outrel;
-  bfd_byte *loc;
+  struct elf_dyn_relocs *head;
+  bfd_size_type rel_index;
 
   outrel.r_offset = _bfd_elf_section_offset(output_bfd, info, input_section, rel->r_offset);
   if (outrel.r_offset == (bfd_vma) -1 || outrel.r_offset == (bfd_vma) -2)
     {
       memset(&outrel, 0, sizeof outrel);
-      return;
+      return true;
     }
 
   outrel.r_offset += (input_section->output_section->vma + input_section->output_offset);
@@ -1292,28 +1756,52 @@ output_dynamic_relocation(bfd *output_bfd, asection *sreloc, asection *input_sec
       BFD_FAIL();
       _bfd_error_handler(_("%pB: probably compiled without -fPIC?"), output_bfd);
       bfd_set_error(bfd_error_bad_value);
-      return;
+      return false;
+    }
+
+  if (h != NULL)
+    head = h->dyn_relocs;
+  else if (sym_sec != NULL && elf_section_data(sym_sec) != NULL)
+    head = (struct elf_dyn_relocs *) elf_section_data(sym_sec)->local_dynrel;
+  else
+    {
+      /* check_relocs counts the relocs against a local symbol in the
+         symbol's section, so there is nowhere to find their slots.  */
+      _bfd_error_handler(_("%pB: dynamic relocation against a local symbol"
+                           " that is not in an ELF section in %pA"),
+                         input_section->owner, input_section);
+      bfd_set_error(bfd_error_bad_value);
+      return false;
     }
 
-  loc = sreloc->contents;
-  loc += sreloc->reloc_count++ * sizeof(Elf32_External_Rela);
-  bfd_elf32_swap_reloca_out(output_bfd, &outrel, loc);
+  rel_index = next_dyn_reloc_index(head, input_section);
+  BFD_ASSERT(rel_index != (bfd_size_type) -1);
+  if (rel_index == (bfd_size_type) -1)
+    return true;
+
+  microblaze_elf_output_dynamic_relocation(output_bfd, sreloc, rel_index,
+                                           ELF32_R_SYM(outrel.r_info),
+                                           ELF32_R_TYPE(outrel.r_info),
+                                           outrel.r_offset, outrel.r_addend);
+  return true;
 }
 
+/* Store VALUE at the R_MICROBLAZE_32 reloc REL, whose address
+   microblaze_elf_size_relative_relocs puts in .relr.dyn, unless the
+   reloc's location was discarded.  */
+
 static void
-write_textrel_relocation(bfd *input_bfd, bfd_byte *contents, bfd_vma offset,
-                        bfd_vma relocation, asection *input_section, int r_type, int endian)
+output_relr_relocation(bfd *output_bfd, struct bfd_link_info *info,
+                       asection *input_section, Elf_Internal_Rela *rel,
+                       bfd_byte *contents, bfd_vma value)
 {
-  if (r_type == R_MICROBLAZE_64_PCREL)
-    relocation -= (input_section->output_section->vma +
-                  input_section->output_offset + offset + INST_WORD_SIZE);
-  else if (r_type == R_MICROBLAZE_TEXTREL_64 || r_type == R_MICROBLAZE_TEXTREL_32_LO)
-    relocation -= input_section->output_section->vma;
-
-  if (r_type == R_MICROBLAZE_TEXTREL_32_LO)
-    bfd_put_16(input_bfd, relocation & MASK_16BIT, contents + offset + endian);
-  else
-    write_64bit_value(input_bfd, contents, offset, relocation, endian);
+  bfd_vma offset = _bfd_elf_section_offset(output_bfd, info, input_section,
+                                           rel->r_offset);
+  
+  if (offset == (bfd_vma) -1 || offset == (bfd_vma) -2)
+    return;
+    
+  bfd_put_32(output_bfd, value, contents + rel->r_offset);
 }
 
 static void
@@ -1368,283 +1856,1064 @@ handle_relocation_error(struct bfd_link_info *info, struct elf_link_hash_entry *
     }
 }
 
-static int
-microblaze_elf_relocate_section(bfd *output_bfd, struct bfd_link_info *info,
-                               bfd *input_bfd, asection *input_section,
-                               bfd_byte *contents, Elf_Internal_Rela *relocs,
-                               Elf_Internal_Sym *local_syms, asection **local_sections)
+/* TLS access models a GD, LD or IE sequence can be relaxed to.  */
+
+enum microblaze_tls_model
 {
-  struct elf32_mb_link_hash_table *htab;
-  Elf_Internal_Shdr *symtab_hdr = &elf_tdata(input_bfd)->symtab_hdr;
-  struct elf_link_hash_entry **sym_hashes = elf_sym_hashes(input_bfd);
-  Elf_Internal_Rela *rel, *relend;
-  int endian = bfd_little_endian(output_bfd) ? 0 : 2;
-  bool ret = true;
-  asection *sreloc;
-  bfd_vma *local_got_offsets;
-  unsigned int tls_type;
+  TLS_MODEL_NONE,
+  TLS_MODEL_IE,
+  TLS_MODEL_LE
+};
 
-  if (!microblaze_elf_howto_table[R_MICROBLAZE_max-1])
-    microblaze_elf_howto_init();
+/* Return the model the TLS reloc R_TYPE against H (NULL for a local
+   symbol) may be relaxed to.  Only executables are relaxed.  Before
+   symbols are resolved (FINAL false) a global symbol goes no further
+   than IE, since it may still turn out to be preemptible.  */
 
-  htab = elf32_mb_hash_table(info);
-  if (htab == NULL)
-    return false;
+static enum microblaze_tls_model
+microblaze_tls_transition (struct bfd_link_info *info, unsigned int r_type,
+			   struct elf_link_hash_entry *h, bool final)
+{
+  if (!bfd_link_executable (info))
+    return TLS_MODEL_NONE;
+  if (r_type == R_MICROBLAZE_TLSLD
+      || h == NULL
+      || (final && SYMBOL_REFERENCES_LOCAL (info, h)))
+    return TLS_MODEL_LE;
+  return TLS_MODEL_IE;
+}
 
-  local_got_offsets = elf_local_got_offsets(input_bfd);
-  sreloc = elf_section_data(input_section)->sreloc;
+/* Return the reloc of the call to __tls_get_addr that consumes the
+   argument set up at the TLS GD or LD reloc REL, or NULL.  Like strchr
+   the result is not const, since relocate_section rewrites it;
+   check_relocs, which sees const relocs, only inspects it.  */
 
-  rel = relocs;
-  relend = relocs + input_section->reloc_count;
-  
-  for (; rel < relend; rel++)
+static Elf_Internal_Rela *
+find_tls_get_addr_call (const Elf_Internal_Rela *rel,
+			const Elf_Internal_Rela *relend,
+			Elf_Internal_Shdr *symtab_hdr,
+			struct elf_link_hash_entry **sym_hashes)
+{
+  const Elf_Internal_Rela *irel;
+
+  for (irel = rel + 1; irel < relend; irel++)
     {
-      int r_type;
-      reloc_howto_type *howto;
-      unsigned long r_symndx;
-      bfd_vma addend = rel->r_addend;
-      bfd_vma offset = rel->r_offset;
+      unsigned int r_type = ELF32_R_TYPE (irel->r_info);
+      unsigned long r_symndx = ELF32_R_SYM (irel->r_info);
       struct elf_link_hash_entry *h;
-      Elf_Internal_Sym *sym;
-      asection *sec;
-      const char *sym_name;
-      bfd_reloc_status_type r = bfd_reloc_ok;
-      const char *errmsg = NULL;
-      bool unresolved_reloc = false;
-
-      h = NULL;
-      r_type = ELF32_R_TYPE(rel->r_info);
-      tls_type = 0;
-
-      if (!validate_relocation_type(input_bfd, r_type))
-        {
-          ret = false;
-          continue;
-        }
 
-      howto = microblaze_elf_howto_table[r_type];
-      r_symndx = ELF32_R_SYM(rel->r_info);
+      if (r_type == R_MICROBLAZE_TLSGD || r_type == R_MICROBLAZE_TLSLD)
+	break;
+      if ((r_type != R_MICROBLAZE_PLT_64
+	   && r_type != R_MICROBLAZE_64_PCREL
+	   && r_type != R_MICROBLAZE_32_PCREL_LO)
+	  || r_symndx < symtab_hdr->sh_info)
+	continue;
+
+      h = sym_hashes[r_symndx - symtab_hdr->sh_info];
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
+      if (strcmp (h->root.root.string, "__tls_get_addr") == 0)
+	return (Elf_Internal_Rela *) irel;
+    }
 
-      if (bfd_link_relocatable(info))
-        {
-          if (!handle_relocatable_link(input_bfd, local_sections, local_syms,
-                                      rel, contents, symtab_hdr, howto))
-            continue;
-        }
-      else
-        {
-          bfd_vma relocation;
-          bool resolved_to_zero;
+  return NULL;
+}
 
-          sym = NULL;
-          sec = NULL;
-          unresolved_reloc = false;
+/* Return the offset of the branch instruction CALL relocates; the
+   relaxed form of a call has lost its "imm" prefix.  */
 
-          get_symbol_info(input_bfd, rel, symtab_hdr, local_syms, local_sections,
-                        sym_hashes, info, &sym, &sec, &h, &sym_name, &relocation,
-                        &unresolved_reloc);
+static bfd_vma
+tls_call_insn_offset (const Elf_Internal_Rela *call)
+{
+  if (ELF32_R_TYPE (call->r_info) == R_MICROBLAZE_32_PCREL_LO)
+    return call->r_offset;
+  return call->r_offset + INST_WORD_SIZE;
+}
 
-          if (r_symndx < symtab_hdr->sh_info && sec == 0)
-            continue;
+/* Return true if CONTENTS hold "imm" followed by an instruction with
+   major opcode OPCODE at OFFSET.  */
 
-          if (offset > bfd_get_section_limit(input_bfd, input_section))
-            {
-              r = bfd_reloc_outofrange;
-              goto check_reloc;
-            }
+static bool
+tls_imm_pair_p (bool big_endian, bfd_byte *contents, bfd_size_type size,
+		bfd_vma offset, bfd_vma opcode)
+{
+  if (offset + 2 * INST_WORD_SIZE > size)
+    return false;
 
-          resolved_to_zero = (h != NULL && UNDEFWEAK_NO_DYNAMIC_RELOC(info, h));
+  return (((microblaze_get_insn (big_endian, contents + offset)
+	    & INST_OPCODE_MASK) == INST_IMM)
+	  && ((microblaze_get_insn (big_endian,
+				    contents + offset + INST_WORD_SIZE)
+	       & INST_OPCODE_MASK) == opcode));
+}
 
-          switch ((int) r_type)
-            {
-            case (int) R_MICROBLAZE_SRO32:
-              if (!process_sro32_relocation(input_bfd, input_section, sec, contents,
-                                           offset, relocation, addend, howto, sym_name, info))
-                {
-                  ret = false;
-                  continue;
-                }
-              break;
-
-            case (int) R_MICROBLAZE_SRW32:
-              if (!process_srw32_relocation(input_bfd, input_section, sec, contents,
-                                           offset, relocation, addend, howto, sym_name, info))
-                {
-                  ret = false;
-                  continue;
-                }
-              break;
-
-            case (int) R_MICROBLAZE_32_SYM_OP_SYM:
-              break;
-
-            case (int) R_MICROBLAZE_GOTPC_64:
-              relocation = (htab->elf.sgotplt->output_section->vma +
-                          htab->elf.sgotplt->output_offset);
-              compute_pc_relative_offset(input_section, &relocation, offset, addend);
-              write_64bit_value(input_bfd, contents, offset, relocation, endian);
-              break;
-
-            case (int) R_MICROBLAZE_TEXTPCREL_64:
-              relocation = input_section->output_section->vma;
-              compute_pc_relative_offset(input_section, &relocation, offset, addend);
-              write_64bit_value(input_bfd, contents, offset, relocation, endian);
-              break;
-
-            case (int) R_MICROBLAZE_PLT_64:
-              {
-                bfd_vma immediate;
-                if (htab->elf.splt != NULL && h != NULL && h->plt.offset != (bfd_vma) -1)
-                  {
-                    relocation = (htab->elf.splt->output_section->vma +
-                                htab->elf.splt->output_offset + h->plt.offset);
-                    unresolved_reloc = false;
-                  }
-                immediate = relocation - (input_section->output_section->vma +
-                                        input_section->output_offset + offset + INST_WORD_SIZE);
-                write_64bit_value(input_bfd, contents, offset, immediate, endian);
-              }
-              break;
-
-            case (int) R_MICROBLAZE_TLSGD:
-              tls_type = (TLS_TLS | TLS_GD);
-              goto dogot;
-            case (int) R_MICROBLAZE_TLSLD:
-              tls_type = (TLS_TLS | TLS_LD);
-            dogot:
-            case (int) R_MICROBLAZE_GOT_64:
-              {
-                bfd_vma *offp;
-                bfd_vma off, off2;
-                unsigned long indx;
-                bfd_vma static_value;
-                bool need_relocs = false;
-
-                if (htab->elf.sgot == NULL)
-                  abort();
-
-                offp = get_got_offset_pointer(htab, h, local_got_offsets, r_symndx, tls_type);
-                if (!offp)
-                  abort();
-
-                off = (*offp) & ~1;
-                off2 = (IS_TLS_LD(tls_type) || IS_TLS_GD(tls_type)) ? off + 4 : off;
-
-                indx = get_symbol_index(info, h);
-
-                if ((bfd_link_pic(info) || indx != 0) &&
-                    (h == NULL || (ELF_ST_VISIBILITY(h->other) == STV_DEFAULT && !resolved_to_zero) ||
-                     h->root.type != bfd_link_hash_undefweak))
-                  need_relocs = true;
-
-                static_value = relocation + addend;
-
-                if (!((*offp) & 1))
-                  {
-                    process_tls_module_id(output_bfd, htab, info, off, tls_type,
-                                        indx, static_value, need_relocs);
-
-                    if (htab->elf.srelgot == NULL)
-                      abort();
-
-                    process_tls_offset(output_bfd, htab, info, off2, tls_type,
-                                     indx, static_value, need_relocs, offp);
-                  }
-
-                relocation = htab->elf.sgot->output_section->vma +
-                           htab->elf.sgot->output_offset + off -
-                           htab->elf.sgotplt->output_section->vma -
-                           htab->elf.sgotplt->output_offset;
-
-                write_64bit_value(input_bfd, contents, offset, relocation, endian);
-                unresolved_reloc = false;
-              }
-              break;
-
-            case (int) R_MICROBLAZE_GOTOFF_64:
-              {
-                bfd_vma immediate;
-                relocation += addend;
-                relocation -= (htab->elf.sgotplt->output_section->vma +
-                             htab->elf.sgotplt->output_offset);
-                immediate = relocation;
-                bfd_put_16(input_bfd, (immediate >> 16) & MASK_16BIT, contents + offset + endian);
-                bfd_put_16(input_bfd, immediate & MASK_16BIT,
-                         contents + offset + INST_WORD_SIZE + endian);
-              }
-              break;
-
-            case (int) R_MICROBLAZE_GOTOFF_32:
-              relocation += addend;
-              relocation -= (htab->elf.sgotplt->output_section->vma +
-                           htab->elf.sgotplt->output_offset);
-              bfd_put_32(input_bfd, relocation, contents + offset);
-              break;
-
-            case (int) R_MICROBLAZE_TLSDTPREL64:
-              relocation += addend;
-              relocation -= dtprel_base(info);
-              write_64bit_value(input_bfd, contents, offset, relocation, endian);
-              break;
-
-            case (int) R_MICROBLAZE_TEXTREL_64:
-            case (int) R_MICROBLAZE_TEXTREL_32_LO:
-            case (int) R_MICROBLAZE_64_PCREL:
-            case (int) R_MICROBLAZE_64:
-            case (int) R_MICROBLAZE_32:
-              {
-                if (r_symndx == STN_UNDEF || (input_section->flags & SEC_ALLOC) == 0)
-                  {
-                    relocation += addend;
-                    if (r_type == R_MICROBLAZE_32)
-                      bfd_put_32(input_bfd, relocation, contents + offset);
-                    else
-                      write_textrel_relocation(input_bfd, contents, offset, relocation,
-                                             input_section, r_type, endian);
-                    break;
-                  }
-
-                if (needs_dynamic_relocation(info, h, resolved_to_zero, howto))
-                  {
-                    BFD_ASSERT(sreloc != NULL);
-                    output_dynamic_relocation(output_bfd, sreloc, input_section, rel,
-                                            h, relocation, addend, r_type, info);
-                    break;
-                  }
-                else
-                  {
-                    relocation += addend;
-                    if (r_type == R_MICROBLAZE_32)
-                      bfd_put_32(input_b
-
-/* Calculate fixup value for reference.  */
+/* Return true if the GD or LD sequence at REL, whose argument is
+   passed to the call at CALL, has the shape the rewrite expects:
+   "imm; addik r5,rA,x" and a later branch and link.  The call is
+   replaced by an add of r5, so the argument must be computed straight
+   into r5; and since the IE form of GD loads through rA, rA must be
+   the GOT pointer there.  check_relocs and relocate_section both ask
+   this, so they agree on which sequences are rewritten.  */
 
-static size_t
-calc_fixup (bfd_vma start, bfd_vma size, asection *sec)
+static bool
+tls_gd_ld_sequence_p (bool big_endian, bfd_byte *contents, bfd_size_type size,
+		      const Elf_Internal_Rela *rel,
+		      const Elf_Internal_Rela *call)
 {
-  struct _microblaze_elf_section_data *sdata;
-  bfd_vma end = start + size;
-  size_t fixup = 0;
-  size_t i;
+  bfd_vma off, insn;
 
-  if (sec == NULL)
-    return 0;
+  if (call == NULL
+      || !tls_imm_pair_p (big_endian, contents, size, rel->r_offset,
+			  INST_ADDIK))
+    return false;
 
-  sdata = microblaze_elf_section_data (sec);
-  if (sdata == NULL)
-    return 0;
+  insn = microblaze_get_insn (big_endian,
+			      contents + rel->r_offset + INST_WORD_SIZE);
+  if (INST_GET_RD (insn) != REG_ARG1
+      || (ELF32_R_TYPE (rel->r_info) == R_MICROBLAZE_TLSGD
+	  && INST_GET_RA (insn) != REG_GOT))
+    return false;
 
-  for (i = 0; i < sdata->relax_count; i++)
+  off = tls_call_insn_offset (call);
+  if (off + INST_WORD_SIZE > size
+      || (off != call->r_offset
+	  && ((microblaze_get_insn (big_endian, contents + call->r_offset)
+	       & INST_OPCODE_MASK) != INST_IMM)))
+    return false;
+
+  insn = microblaze_get_insn (big_endian, contents + off);
+  if ((insn & INST_OPCODE_MASK) != INST_BRI
+      || (insn & INST_BRANCH_LINK) == 0)
+    return false;
+
+  return ((insn & INST_BRANCH_DELAY) == 0
+	  || off + 2 * INST_WORD_SIZE <= size);
+}
+
+/* Replace the call to __tls_get_addr at CALL by "addk r3,r5,r21", the
+   argument register now holding the offset from the thread pointer.
+   An instruction in the delay slot is hoisted into the branch's place
+   and takes its reloc along.  */
+
+static void
+microblaze_tls_rewrite_call (bool big_endian, bfd_byte *contents,
+			     Elf_Internal_Rela *call, Elf_Internal_Rela *relend)
+{
+  bfd_vma off = tls_call_insn_offset (call);
+  bfd_vma insn = microblaze_get_insn (big_endian, contents + off);
+  Elf_Internal_Rela *irel;
+
+  if (off != call->r_offset)
+    microblaze_put_insn (big_endian, INST_NOP, contents + call->r_offset);
+
+  if (insn & INST_BRANCH_DELAY)
+    {
+      memcpy (contents + off, contents + off + INST_WORD_SIZE,
+	      INST_WORD_SIZE);
+      off += INST_WORD_SIZE;
+      for (irel = call + 1; irel < relend && irel->r_offset <= off; irel++)
+	if (irel->r_offset == off)
+	  irel->r_offset -= INST_WORD_SIZE;
+    }
+
+  microblaze_put_insn (big_endian,
+		       (INST_ADDK | INST_RD (REG_RET) | INST_RA (REG_ARG1)
+			| INST_RB (REG_TP)), contents + off);
+  call->r_info = ELF32_R_INFO (ELF32_R_SYM (call->r_info), R_MICROBLAZE_NONE);
+}
+
+/* Return true if a GOT_64 load of H may be rewritten to address the
+   symbol relative to the GOT pointer instead.  For a local symbol H is
+   NULL and ABS_LOCAL says whether it is absolute, which rules it out
+   in a PIC link.  Before symbols are resolved (FINAL false) any non-TLS
+   global is a candidate.  */
+
+static bool
+microblaze_gotoff_relaxable (struct bfd_link_info *info,
+			     struct elf_link_hash_entry *h,
+			     bool abs_local, bool final)
+{
+  if (h == NULL)
+    return !(abs_local && bfd_link_pic (info));
+  if ((elf32_mb_hash_entry (h)->tls_mask & TLS_TLS) != 0)
+    return false;
+  if (!final)
+    return true;
+  if ((h->root.type != bfd_link_hash_defined
+       && h->root.type != bfd_link_hash_defweak)
+      || !SYMBOL_REFERENCES_LOCAL (info, h))
+    return false;
+  return !(bfd_link_pic (info)
+	   && bfd_is_abs_section (h->root.u.def.section));
+}
+
+/* Return the TLS mask check_relocs recorded for the GOT entry of H, or
+   of local symbol R_SYMNDX when H is NULL.  */
+
+static unsigned char
+microblaze_got_tls_mask (bfd *abfd, struct elf_link_hash_entry *h,
+			 unsigned long r_symndx, Elf_Internal_Shdr *symtab_hdr)
+{
+  if (h != NULL)
+    return elf32_mb_hash_entry (h)->tls_mask;
+  if (elf_local_got_offsets (abfd) == NULL)
+    return 0;
+  return ((unsigned char *) (elf_local_got_offsets (abfd)
+			     + symtab_hdr->sh_info))[r_symndx];
+}
+
+/* Values relocate_section needs for every reloc of one input section,
+   computed once before the relocs are walked.  */
+
+struct microblaze_reloc_ctx
+{
+  bfd *output_bfd;
+  struct bfd_link_info *info;
+  struct elf32_mb_link_hash_table *htab;
+  bfd *input_bfd;
+  asection *input_section;
+  bfd_byte *contents;
+  Elf_Internal_Rela *relend;
+  Elf_Internal_Shdr *symtab_hdr;
+  struct elf_link_hash_entry **sym_hashes;
+  bfd_vma *local_got_offsets;
+  asection *sreloc;
+  bool big_endian;
+
+  /* Output addresses of the input section and of its output section.  */
+  bfd_vma sec_base;
+  bfd_vma text_base;
+
+  /* Output addresses of .got and .got.plt, or zero if they are absent.  */
+  bfd_vma got_base;
+  bfd_vma gotplt_base;
+
+  /* The link's dtprel_base and tprel_base.  */
+  bfd_vma dtprel_base;
+  bfd_vma tprel_base;
+
+  /* Immediate fields to be written once all relocs are applied.  */
+  struct microblaze_patch_buf *patches;
+};
+
+/* Kinds of immediate field patches: the 32-bit value split over an
+   "imm" and the following instruction, or a low half alone.  */
+enum
+{
+  IMM_PATCH_PAIR,
+  IMM_PATCH_LO
+};
+
+struct microblaze_imm_patch
+{
+  bfd_vma offset;
+  bfd_vma value;
+  unsigned int kind;
+};
+
+/* The patches collected for one input section.  relocate_section
+   reserves one per reloc, the most it can need.  */
+
+struct microblaze_patch_buf
+{
+  struct microblaze_imm_patch *patch;
+  size_t count;
+  size_t alloc;
+};
+
+/* Queue VALUE for the immediate field(s) at OFFSET.  Without a buffer
+   the field is written at once.  Only the 16-bit immediates are
+   touched, so instructions rewritten meanwhile keep their opcodes.  */
+
+static void
+queue_imm_patch(const struct microblaze_reloc_ctx *ctx, bfd_vma offset,
+                bfd_vma value, unsigned int kind)
+{
+  struct microblaze_patch_buf *buf = ctx->patches;
+
+  if (buf->count < buf->alloc)
+    {
+      struct microblaze_imm_patch *p = &buf->patch[buf->count++];
+
+      p->offset = offset;
+      p->value = value;
+      p->kind = kind;
+    }
+  else if (kind == IMM_PATCH_LO)
+    microblaze_put_imm(ctx->big_endian, value & MASK_16BIT,
+                       ctx->contents + offset);
+  else
+    write_64bit_value(ctx->big_endian, ctx->contents, offset, value);
+}
+
+/* Write the queued patches into big-endian CONTENTS, where the
+   immediate is the second half of each instruction word.  */
+
+static void
+apply_imm_patches_be(bfd_byte *contents, const struct microblaze_imm_patch *p,
+                     size_t count)
+{
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      bfd_byte *loc = contents + p[i].offset;
+      bfd_vma value = p[i].value;
+
+      if (p[i].kind == IMM_PATCH_LO)
+        {
+          loc[2] = value >> 8;
+          loc[3] = value;
+        }
+      else
+        {
+          loc[2] = value >> 24;
+          loc[3] = value >> 16;
+          loc[INST_WORD_SIZE + 2] = value >> 8;
+          loc[INST_WORD_SIZE + 3] = value;
+        }
+    }
+}
+
+/* Likewise for little-endian CONTENTS, where the immediate is the first
+   half of each instruction word.  */
+
+static void
+apply_imm_patches_le(bfd_byte *contents, const struct microblaze_imm_patch *p,
+                     size_t count)
+{
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      bfd_byte *loc = contents + p[i].offset;
+      bfd_vma value = p[i].value;
+
+      if (p[i].kind == IMM_PATCH_LO)
+        {
+          loc[0] = value;
+          loc[1] = value >> 8;
+        }
+      else
+        {
+          loc[0] = value >> 16;
+          loc[1] = value >> 24;
+          loc[INST_WORD_SIZE] = value;
+          loc[INST_WORD_SIZE + 1] = value >> 8;
+        }
+    }
+}
+
+/* One reloc being applied, with its symbol resolved.  The apply
+   function may update RELOCATION and sets STATUS for any error to be
+   reported.  */
+
+struct microblaze_reloc
+{
+  Elf_Internal_Rela *rel;
+  int r_type;
+  reloc_howto_type *howto;
+  unsigned long r_symndx;
+  struct elf_link_hash_entry *h;
+  Elf_Internal_Sym *sym;
+  asection *sec;
+  const char *sym_name;
+  bfd_vma relocation;
+  bfd_vma addend;
+  bfd_vma offset;
+  bool resolved_to_zero;
+  bfd_reloc_status_type status;
+};
+
+/* Apply the reloc R.  Return false if the link must fail; any error
+   has already been reported.  */
+
+typedef bool (*microblaze_apply_fn) (const struct microblaze_reloc_ctx *,
+                                     struct microblaze_reloc *);
+
+static bool
+apply_sda_reloc(const struct microblaze_reloc_ctx *ctx,
+                struct microblaze_reloc *r)
+{
+  if (r->r_type == R_MICROBLAZE_SRO32)
+    return process_sro32_relocation(ctx->input_bfd, ctx->input_section, r->sec,
+                                    ctx->contents, r->offset, r->relocation,
+                                    r->addend, r->howto, r->sym_name, ctx->info);
+  return process_srw32_relocation(ctx->input_bfd, ctx->input_section, r->sec,
+                                  ctx->contents, r->offset, r->relocation,
+                                  r->addend, r->howto, r->sym_name, ctx->info);
+}
+
+static bool
+apply_no_reloc(const struct microblaze_reloc_ctx *ctx ATTRIBUTE_UNUSED,
+               struct microblaze_reloc *r ATTRIBUTE_UNUSED)
+{
+  return true;
+}
+
+static bool
+apply_gotpc_64_reloc(const struct microblaze_reloc_ctx *ctx,
+                     struct microblaze_reloc *r)
+{
+  r->relocation = (ctx->gotplt_base + r->addend
+                   - (ctx->sec_base + r->offset + INST_WORD_SIZE));
+  queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+  return true;
+}
+
+static bool
+apply_textpcrel_64_reloc(const struct microblaze_reloc_ctx *ctx,
+                         struct microblaze_reloc *r)
+{
+  r->relocation = (ctx->text_base + r->addend
+                   - (ctx->sec_base + r->offset + INST_WORD_SIZE));
+  queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+  return true;
+}
+
+static bool
+apply_plt_64_reloc(const struct microblaze_reloc_ctx *ctx,
+                   struct microblaze_reloc *r)
+{
+  struct elf32_mb_link_hash_table *htab = ctx->htab;
+  struct elf_link_hash_entry *h = r->h;
+
+  if (htab->elf.splt != NULL && h != NULL && h->plt.offset != (bfd_vma) -1)
+    r->relocation = (htab->elf.splt->output_section->vma
+                     + htab->elf.splt->output_offset + h->plt.offset);
+  queue_imm_patch(ctx, r->offset,
+                  (r->relocation
+                   - (ctx->sec_base + r->offset + INST_WORD_SIZE)),
+                  IMM_PATCH_PAIR);
+  return true;
+}
+
+/* Point the GOT reference R at the entry for TLS_TYPE (zero for a
+   plain GOT entry).  The first reference initializes the entry's words
+   and dynamic relocs, in the slots reserved for them.  */
+
+static bool
+apply_got_entry_reloc(const struct microblaze_reloc_ctx *ctx,
+                      struct microblaze_reloc *r, unsigned int tls_type)
+{
+  struct elf32_mb_link_hash_table *htab = ctx->htab;
+  struct bfd_link_info *info = ctx->info;
+  struct elf_link_hash_entry *h = r->h;
+  bfd_vma *offp;
+  bfd_vma base, off, off2, done, got_ref;
+  unsigned long indx;
+  bfd_vma static_value;
+  bool need_relocs = false;
+  bfd_size_type rel_index;
+
+  if (htab->elf.sgot == NULL)
+    abort();
+
+  offp = get_got_offset_pointer(htab, h, ctx->local_got_offsets, r->r_symndx,
+                                tls_type);
+  if (!offp)
+    abort();
+
+  base = *offp & ~(bfd_vma) GOT_DONE_MASK;
+  off = base;
+  done = GOT_DONE_ENTRY;
+  if (IS_TLS_TPREL(tls_type))
+    {
+      done = GOT_DONE_TPREL;
+      /* The IE slot follows the GD pair when both exist.  */
+      if ((microblaze_got_tls_mask(ctx->input_bfd, h, r->r_symndx,
+                                   ctx->symtab_hdr) & TLS_GD) != 0)
+        off += 8;
+    }
+  got_ref = ctx->got_base + off - ctx->gotplt_base;
+  if ((*offp & done) != 0)
+    {
+      r->relocation = got_ref;
+      queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+      return true;
+    }
+  *offp |= done;
+
+  off2 = (IS_TLS_LD(tls_type) || IS_TLS_GD(tls_type)) ? off + 4 : off;
+  rel_index = (get_got_rel_index(htab, ctx->input_bfd, h, r->r_symndx, tls_type)
+               + (off - base) / 4);
+
+  indx = get_symbol_index(info, h);
+
+  if ((bfd_link_pic(info) || indx != 0) &&
+      (h == NULL || (ELF_ST_VISIBILITY(h->other) == STV_DEFAULT && !r->resolved_to_zero) ||
+       h->root.type != bfd_link_hash_undefweak))
+    need_relocs = true;
+
+  static_value = r->relocation + r->addend;
+
+  if (htab->elf.srelgot == NULL)
+    abort();
+
+  process_tls_module_id(ctx->output_bfd, htab, info, off, rel_index,
+                        tls_type, indx, static_value, need_relocs);
+  process_tls_offset(ctx->output_bfd, htab, info, off2,
+                     rel_index + (off2 - off) / 4, tls_type,
+                     indx, static_value, need_relocs);
+
+  r->relocation = got_ref;
+  queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+  return true;
+}
+
+static bool
+apply_tls_gd_ld_reloc(const struct microblaze_reloc_ctx *ctx,
+                      struct microblaze_reloc *r)
+{
+  bfd_byte *contents = ctx->contents;
+  Elf_Internal_Rela *call;
+  enum microblaze_tls_model model = TLS_MODEL_NONE;
+  bfd_vma insn = 0;
+
+  call = find_tls_get_addr_call(r->rel, ctx->relend, ctx->symtab_hdr,
+                                ctx->sym_hashes);
+  if (tls_gd_ld_sequence_p(ctx->big_endian, contents,
+                           ctx->input_section->size, r->rel, call))
+    model = microblaze_tls_transition(ctx->info, r->r_type, r->h, true);
+
+  if (model != TLS_MODEL_NONE)
+    {
+      insn = microblaze_get_insn(ctx->big_endian,
+                                 contents + r->offset + INST_WORD_SIZE);
+      microblaze_tls_rewrite_call(ctx->big_endian, contents, call, ctx->relend);
+    }
+
+  if (model == TLS_MODEL_LE)
+    {
+      /* "addik rD,r0,tprel": the offset of the symbol, or of the
+         module's TLS block, from the thread pointer.  */
+      if (r->r_type == R_MICROBLAZE_TLSGD)
+        r->relocation += r->addend - ctx->tprel_base;
+      else
+        r->relocation = ctx->dtprel_base - ctx->tprel_base;
+      microblaze_put_insn(ctx->big_endian, INST_ADDIK | (insn & INST_RD_MASK),
+                          contents + r->offset + INST_WORD_SIZE);
+      queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+      return true;
+    }
+
+  if (model == TLS_MODEL_IE)
+    {
+      /* "lwi rD,rA,x@TLSGOTTPREL" off the same GOT pointer.  */
+      microblaze_put_insn(ctx->big_endian,
+                          INST_LWI | (insn & (INST_RD_MASK | INST_RA_MASK)),
+                          contents + r->offset + INST_WORD_SIZE);
+      return apply_got_entry_reloc(ctx, r, TLS_TLS | TLS_TPREL);
+    }
+
+  return apply_got_entry_reloc(ctx, r, (r->r_type == R_MICROBLAZE_TLSGD
+                                        ? (TLS_TLS | TLS_GD)
+                                        : (TLS_TLS | TLS_LD)));
+}
+
+static bool
+apply_tls_gottprel_reloc(const struct microblaze_reloc_ctx *ctx,
+                         struct microblaze_reloc *r)
+{
+  bfd_byte *contents = ctx->contents;
+
+  if (microblaze_tls_transition(ctx->info, r->r_type, r->h, true) == TLS_MODEL_LE
+      && tls_imm_pair_p(ctx->big_endian, contents, ctx->input_section->size,
+                        r->offset, INST_LWI))
+    {
+      bfd_vma insn = microblaze_get_insn(ctx->big_endian,
+                                         contents + r->offset + INST_WORD_SIZE);
+
+      microblaze_put_insn(ctx->big_endian, INST_ADDIK | (insn & INST_RD_MASK),
+                          contents + r->offset + INST_WORD_SIZE);
+      r->relocation += r->addend - ctx->tprel_base;
+      queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+      return true;
+    }
+  return apply_got_entry_reloc(ctx, r, TLS_TLS | TLS_TPREL);
+}
+
+static bool
+apply_got_64_reloc(const struct microblaze_reloc_ctx *ctx,
+                   struct microblaze_reloc *r)
+{
+  bfd_byte *contents = ctx->contents;
+
+  if (microblaze_gotoff_relaxable(ctx->info, r->h,
+                                  r->sym != NULL && r->sym->st_shndx == SHN_ABS,
+                                  true)
+      && tls_imm_pair_p(ctx->big_endian, contents, ctx->input_section->size,
+                        r->offset, INST_LWI))
+    {
+      /* "lwi rD,rA,x@GOT" becomes "addik rD,rA,x@GOTOFF".  */
+      bfd_vma insn = microblaze_get_insn(ctx->big_endian,
+                                         contents + r->offset + INST_WORD_SIZE);
+
+      microblaze_put_insn(ctx->big_endian,
+                          INST_ADDIK | (insn & (INST_RD_MASK | INST_RA_MASK)),
+                          contents + r->offset + INST_WORD_SIZE);
+      r->relocation += r->addend - ctx->gotplt_base;
+      queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+      return true;
+    }
+  return apply_got_entry_reloc(ctx, r, 0);
+}
+
+static bool
+apply_gotoff_reloc(const struct microblaze_reloc_ctx *ctx,
+                   struct microblaze_reloc *r)
+{
+  r->relocation += r->addend - ctx->gotplt_base;
+  if (r->r_type == R_MICROBLAZE_GOTOFF_32)
+    microblaze_put_insn(ctx->big_endian, r->relocation,
+                        ctx->contents + r->offset);
+  else
+    queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+  return true;
+}
+
+static bool
+apply_tls_dtprel_64_reloc(const struct microblaze_reloc_ctx *ctx,
+                          struct microblaze_reloc *r)
+{
+  r->relocation += r->addend - ctx->dtprel_base;
+  queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+  return true;
+}
+
+static bool
+apply_tls_tprel_32_reloc(const struct microblaze_reloc_ctx *ctx,
+                         struct microblaze_reloc *r)
+{
+  r->relocation += r->addend - ctx->tprel_base;
+  queue_imm_patch(ctx, r->offset, r->relocation, IMM_PATCH_PAIR);
+  return true;
+}
+
+/* Store the resolved value of an absolute or PC-relative reloc R in
+   the section contents.  */
+
+static void
+write_direct_value(const struct microblaze_reloc_ctx *ctx,
+                   struct microblaze_reloc *r)
+{
+  bfd_vma value;
+
+  r->relocation += r->addend;
+  if (r->r_type == R_MICROBLAZE_32)
+    {
+      microblaze_put_insn(ctx->big_endian, r->relocation,
+                          ctx->contents + r->offset);
+      return;
+    }
+
+  value = r->relocation;
+  if (r->r_type == R_MICROBLAZE_64_PCREL)
+    value -= ctx->sec_base + r->offset + INST_WORD_SIZE;
+  else if (r->r_type == R_MICROBLAZE_TEXTREL_64
+           || r->r_type == R_MICROBLAZE_TEXTREL_32_LO)
+    value -= ctx->text_base;
+
+  queue_imm_patch(ctx, r->offset, value,
+                  (r->r_type == R_MICROBLAZE_TEXTREL_32_LO
+                   ? IMM_PATCH_LO : IMM_PATCH_PAIR));
+}
+
+static bool
+apply_direct_reloc(const struct microblaze_reloc_ctx *ctx,
+                   struct microblaze_reloc *r)
+{
+  if (r->r_symndx == STN_UNDEF || (ctx->input_section->flags & SEC_ALLOC) == 0)
+    {
+      write_direct_value(ctx, r);
+      return true;
+    }
+
+  if (needs_dynamic_relocation(ctx->info, r->h, r->resolved_to_zero, r->howto))
+    {
+      if (r->h == NULL
+          && microblaze_elf_relr_reloc_p(ctx->info, ctx->htab, ctx->input_section,
+                                         r->r_type, r->rel->r_offset))
+        {
+          output_relr_relocation(ctx->output_bfd, ctx->info,
+                                 ctx->input_section, r->rel, ctx->contents,
+                                 r->relocation + r->addend);
+          return true;
+        }
+      BFD_ASSERT(ctx->sreloc != NULL);
+      return output_dynamic_relocation(ctx->output_bfd, ctx->sreloc,
+                                       ctx->input_section, r->rel, r->h,
+                                       r->sec, r->relocation, r->addend,
+                                       r->r_type, ctx->info);
+    }
+
+  write_direct_value(ctx, r);
+  return true;
+}
+
+static bool
+apply_generic_reloc(const struct microblaze_reloc_ctx *ctx,
+                    struct microblaze_reloc *r)
+{
+  r->status = _bfd_final_link_relocate(r->howto, ctx->input_bfd,
+                                       ctx->input_section, ctx->contents,
+                                       r->offset, r->relocation, r->addend);
+  return true;
+}
+
+/* How relocate_section applies each reloc type.  Types without an
+   entry go through _bfd_final_link_relocate.  */
+
+static const microblaze_apply_fn microblaze_apply_table[R_MICROBLAZE_max] =
+{
+  [R_MICROBLAZE_SRO32] = apply_sda_reloc,
+  [R_MICROBLAZE_SRW32] = apply_sda_reloc,
+  [R_MICROBLAZE_32_SYM_OP_SYM] = apply_no_reloc,
+  [R_MICROBLAZE_GOTPC_64] = apply_gotpc_64_reloc,
+  [R_MICROBLAZE_TEXTPCREL_64] = apply_textpcrel_64_reloc,
+  [R_MICROBLAZE_PLT_64] = apply_plt_64_reloc,
+  [R_MICROBLAZE_TLSGD] = apply_tls_gd_ld_reloc,
+  [R_MICROBLAZE_TLSLD] = apply_tls_gd_ld_reloc,
+  [R_MICROBLAZE_TLSGOTTPREL32] = apply_tls_gottprel_reloc,
+  [R_MICROBLAZE_GOT_64] = apply_got_64_reloc,
+  [R_MICROBLAZE_GOTOFF_64] = apply_gotoff_reloc,
+  [R_MICROBLAZE_GOTOFF_32] = apply_gotoff_reloc,
+  [R_MICROBLAZE_TLSDTPREL64] = apply_tls_dtprel_64_reloc,
+  [R_MICROBLAZE_TLSTPREL32] = apply_tls_tprel_32_reloc,
+  [R_MICROBLAZE_TEXTREL_64] = apply_direct_reloc,
+  [R_MICROBLAZE_TEXTREL_32_LO] = apply_direct_reloc,
+  [R_MICROBLAZE_64_PCREL] = apply_direct_reloc,
+  [R_MICROBLAZE_64] = apply_direct_reloc,
+  [R_MICROBLAZE_32] = apply_direct_reloc,
+};
+
+static bfd_vma
+section_output_address(asection *sec)
+{
+  if (sec == NULL)
+    return 0;
+  return sec->output_section->vma + sec->output_offset;
+}
+
+/* Relocate REL, one reloc of the section described by CTX.  Return
+   false if the link should fail.  */
+
+static bool
+microblaze_relocate_one(const struct microblaze_reloc_ctx *ctx,
+                        Elf_Internal_Rela *rel, Elf_Internal_Sym *local_syms,
+                        asection **local_sections, bfd_vma sec_limit)
+{
+  struct microblaze_reloc r;
+  microblaze_apply_fn apply;
+  bfd *input_bfd = ctx->input_bfd;
+  struct bfd_link_info *info = ctx->info;
+  bool unresolved_reloc = false;
+
+  r.rel = rel;
+  r.r_type = ELF32_R_TYPE(rel->r_info);
+  r.addend = rel->r_addend;
+  r.offset = rel->r_offset;
+  r.h = NULL;
+  r.sym = NULL;
+  r.sec = NULL;
+  r.relocation = 0;
+  r.status = bfd_reloc_ok;
+
+  if (!validate_relocation_type(input_bfd, r.r_type))
+    return false;
+
+  r.howto = &microblaze_elf_howto_table[r.r_type];
+  r.r_symndx = ELF32_R_SYM(rel->r_info);
+
+  if (bfd_link_relocatable(info))
+    {
+      handle_relocatable_link(input_bfd, local_sections, local_syms,
+                              rel, ctx->contents, ctx->symtab_hdr, r.howto);
+      return true;
+    }
+
+  get_symbol_info(input_bfd, rel, ctx->symtab_hdr, local_syms, local_sections,
+                  ctx->sym_hashes, info, &r.sym, &r.sec, &r.h, &r.sym_name,
+                  &r.relocation, &unresolved_reloc);
+
+  if (r.r_symndx < ctx->symtab_hdr->sh_info && r.sec == 0)
+    return true;
+
+  /* r_addend may have changed if the reference section was a merge
+     section.  */
+  r.addend = rel->r_addend;
+
+  if (r.offset > sec_limit)
+    r.status = bfd_reloc_outofrange;
+  else
+    {
+      r.resolved_to_zero = (r.h != NULL
+                            && UNDEFWEAK_NO_DYNAMIC_RELOC(info, r.h));
+
+      apply = microblaze_apply_table[r.r_type];
+      if (apply == NULL)
+        apply = apply_generic_reloc;
+      if (!apply(ctx, &r))
+        return false;
+    }
+
+  if (r.status != bfd_reloc_ok)
+    handle_relocation_error(info, r.h, r.sym, r.sec, input_bfd,
+                            ctx->input_section, r.offset, ctx->symtab_hdr,
+                            r.status, r.howto, NULL);
+  return true;
+}
+
+/* Relocate a section that is not loaded, such as .debug_info.  Nearly
+   all of its relocs are R_MICROBLAZE_32 against a local symbol or a
+   defined global, which cannot need a dynamic reloc here; those are
+   resolved and stored in one pass.  Anything else, including every
+   reloc that might have to be diagnosed, goes through
+   microblaze_relocate_one.  The caller passes BIG_ENDIAN as a constant,
+   so that each byte order gets its own copy of the loop.  */
+
+static inline bool
+microblaze_relocate_nonalloc(const struct microblaze_reloc_ctx *ctx,
+                             Elf_Internal_Rela *relocs,
+                             Elf_Internal_Sym *local_syms,
+                             asection **local_sections, bfd_vma sec_limit,
+                             bool big_endian)
+{
+  Elf_Internal_Rela *rel;
+  unsigned long nlocals = ctx->symtab_hdr->sh_info;
+  bfd_byte *contents = ctx->contents;
+  bool unwrap = (ctx->info->wrap_hash != NULL
+                 && (ctx->input_section->flags & SEC_DEBUGGING) != 0);
+  bool ret = true;
+
+  for (rel = relocs; rel < ctx->relend; rel++)
+    {
+      unsigned long r_symndx = ELF32_R_SYM(rel->r_info);
+      bfd_vma relocation;
+
+      if (ELF32_R_TYPE(rel->r_info) != R_MICROBLAZE_32
+          || rel->r_offset > sec_limit)
+        {
+          if (!microblaze_relocate_one(ctx, rel, local_syms, local_sections,
+                                       sec_limit))
+            ret = false;
+          continue;
+        }
+
+      if (r_symndx < nlocals)
+        {
+          asection *sec = local_sections[r_symndx];
+
+          if (sec == NULL)
+            continue;
+          relocation = _bfd_elf_rela_local_sym(ctx->output_bfd,
+                                               local_syms + r_symndx,
+                                               &sec, rel);
+        }
+      else
+        {
+          struct elf_link_hash_entry *h
+            = ctx->sym_hashes[r_symndx - nlocals];
+          asection *sec = NULL;
+
+          /* With --wrap, references from debug sections resolve to the
+             unwrapped symbol; leave that to RELOC_FOR_GLOBAL_SYMBOL.  */
+          if (h != NULL && !unwrap)
+            {
+              while (h->root.type == bfd_link_hash_indirect
+                     || h->root.type == bfd_link_hash_warning)
+                h = (struct elf_link_hash_entry *) h->root.u.i.link;
+              if (h->root.type == bfd_link_hash_defined
+                  || h->root.type == bfd_link_hash_defweak)
+                sec = h->root.u.def.section;
+            }
+
+          if (sec == NULL || sec->output_section == NULL)
+            {
+              if (!microblaze_relocate_one(ctx, rel, local_syms,
+                                           local_sections, sec_limit))
+                ret = false;
+              continue;
+            }
+          relocation = (h->root.u.def.value + sec->output_section->vma
+                        + sec->output_offset);
+        }
+
+      microblaze_put_insn(big_endian, relocation + rel->r_addend,
+                          contents + rel->r_offset);
+    }
+
+  return ret;
+}
+
+static int
+microblaze_elf_relocate_section(bfd *output_bfd, struct bfd_link_info *info,
+                               bfd *input_bfd, asection *input_section,
+                               bfd_byte *contents, Elf_Internal_Rela *relocs,
+                               Elf_Internal_Sym *local_syms, asection **local_sections)
+{
+  struct microblaze_reloc_ctx ctx;
+  struct microblaze_patch_buf patches;
+  struct elf32_mb_link_hash_table *htab;
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata(input_bfd)->symtab_hdr;
+  Elf_Internal_Rela *rel, *relend;
+  bfd_vma sec_limit;
+  bool nonalloc;
+  bool ret = true;
+
+  htab = elf32_mb_hash_table(info);
+  if (htab == NULL)
+    return false;
+
+  nonalloc = (!bfd_link_relocatable(info)
+              && (input_section->flags & SEC_ALLOC) == 0);
+
+  rel = relocs;
+  relend = relocs + input_section->reloc_count;
+
+  ctx.output_bfd = output_bfd;
+  ctx.info = info;
+  ctx.htab = htab;
+  ctx.input_bfd = input_bfd;
+  ctx.input_section = input_section;
+  ctx.contents = contents;
+  ctx.relend = relend;
+  ctx.symtab_hdr = symtab_hdr;
+  ctx.sym_hashes = elf_sym_hashes(input_bfd);
+  ctx.local_got_offsets = elf_local_got_offsets(input_bfd);
+  ctx.sreloc = elf_section_data(input_section)->sreloc;
+  ctx.big_endian = htab->big_endian;
+  ctx.sec_base = section_output_address(input_section);
+  ctx.text_base = input_section->output_section->vma;
+  ctx.got_base = section_output_address(htab->elf.sgot);
+  ctx.gotplt_base = section_output_address(htab->elf.sgotplt);
+  ctx.dtprel_base = dtprel_base(info);
+  ctx.tprel_base = tprel_base(info);
+  ctx.patches = &patches;
+  sec_limit = bfd_get_section_limit(input_bfd, input_section);
+
+  /* If the buffer cannot be had, patches are written as they come.
+     Sections outside the image hardly ever hold imm pairs, so they do
+     without.  */
+  patches.count = 0;
+  patches.alloc = 0;
+  patches.patch = NULL;
+  if (!bfd_link_relocatable(info) && !nonalloc
+      && input_section->reloc_count != 0)
+    {
+      patches.patch = (struct microblaze_imm_patch *)
+        bfd_malloc(input_section->reloc_count * sizeof (*patches.patch));
+      if (patches.patch != NULL)
+        patches.alloc = input_section->reloc_count;
+    }
+
+  /* Section placement is final by now, so the anchors are looked up
+     once for the whole link.  */
+  if (!bfd_link_relocatable(info))
+    microblaze_elf_final_sdp(info, htab);
+
+  if (nonalloc && ctx.big_endian)
+    ret = microblaze_relocate_nonalloc(&ctx, relocs, local_syms,
+                                       local_sections, sec_limit, true);
+  else if (nonalloc)
+    ret = microblaze_relocate_nonalloc(&ctx, relocs, local_syms,
+                                       local_sections, sec_limit, false);
+  else
+    for (; rel < relend; rel++)
+      if (!microblaze_relocate_one(&ctx, rel, local_syms, local_sections,
+                                   sec_limit))
+        ret = false;
+
+  if (ctx.big_endian)
+    apply_imm_patches_be(contents, patches.patch, patches.count);
+  else
+    apply_imm_patches_le(contents, patches.patch, patches.count);
+  free(patches.patch);
+
+  return ret;
+}
+
+/* Return the index of the first relax table entry of SDATA at or above
+   ADDR, or the sentinel index if there is none.  */
+
+static size_t
+relax_lower_bound (struct _microblaze_elf_section_data *sdata, bfd_vma addr)
+{
+  size_t lo = 0;
+  size_t hi = sdata->relax_count;
+
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (sdata->relax[mid].addr < addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo;
+}
+
+#ifdef MICROBLAZE_CHECK_RELAX
+/* The linear scan calc_fixup used before the relax table was indexed.
+   Building with MICROBLAZE_CHECK_RELAX defined checks every calc_fixup
+   answer against it, since the tree has no testsuite to run a relaxed
+   link through.  */
+
+static size_t
+calc_fixup_linear (bfd_vma start, bfd_vma size,
+		   struct _microblaze_elf_section_data *sdata)
+{
+  bfd_vma end = start + size;
+  size_t fixup = 0;
+  size_t i;
+
+  for (i = 0; i < sdata->relax_count; i++)
     {
       if (end <= sdata->relax[i].addr)
-        break;
-      
+	break;
+
       if (end == start || start <= sdata->relax[i].addr)
-        fixup += sdata->relax[i].size;
+	fixup += sdata->relax[i].size;
     }
 
   return fixup;
 }
+#endif
+
+/* Calculate fixup value for reference.  With SIZE zero this is the
+   number of bytes deleted below START, otherwise the number of bytes
+   deleted in [START, START + SIZE).  */
+
+static size_t
+calc_fixup (bfd_vma start, bfd_vma size, asection *sec)
+{
+  struct _microblaze_elf_section_data *sdata;
+  size_t first;
+  size_t fixup;
+
+  if (sec == NULL)
+    return 0;
+
+  sdata = microblaze_elf_section_data (sec);
+  if (sdata == NULL || sdata->relax_count == 0)
+    return 0;
+
+  first = relax_lower_bound (sdata, start);
+  if (size == 0)
+    fixup = sdata->relax[first].cum_size;
+  else
+    fixup = (sdata->relax[relax_lower_bound (sdata, start + size)].cum_size
+	     - sdata->relax[first].cum_size);
+
+#ifdef MICROBLAZE_CHECK_RELAX
+  BFD_ASSERT (fixup == calc_fixup_linear (start, size, sdata));
+#endif
+  return fixup;
+}
 
 /* Read-modify-write into the bfd, an immediate value into appropriate fields of
    a 32-bit instruction.  */
@@ -1653,10 +2922,8 @@ microblaze_bfd_write_imm_value_32 (bfd *abfd, bfd_byte *bfd_addr, bfd_vma val)
 {
     #define IMM_VALUE_MASK 0x0000ffff
     
-    unsigned long instr = bfd_get_32 (abfd, bfd_addr);
-    instr &= ~IMM_VALUE_MASK;
-    instr |= (val & IMM_VALUE_MASK);
-    bfd_put_32 (abfd, instr, bfd_addr);
+    microblaze_put_imm (elf32_mb_tdata (abfd)->big_endian,
+                        val & IMM_VALUE_MASK, bfd_addr);
 }
 
 /* Read-modify-write into the bfd, an immediate value into appropriate fields of
@@ -1667,18 +2934,11 @@ microblaze_bfd_write_imm_value_64 (bfd *abfd, bfd_byte *bfd_addr, bfd_vma val)
     #define IMM_MASK 0x0000ffff
     #define IMM_SHIFT 16
     
-    unsigned long instr_hi;
-    unsigned long instr_lo;
-
-    instr_hi = bfd_get_32 (abfd, bfd_addr);
-    instr_hi &= ~IMM_MASK;
-    instr_hi |= ((val >> IMM_SHIFT) & IMM_MASK);
-    bfd_put_32 (abfd, instr_hi, bfd_addr);
+    bool big_endian = elf32_mb_tdata (abfd)->big_endian;
 
-    instr_lo = bfd_get_32 (abfd, bfd_addr + INST_WORD_SIZE);
-    instr_lo &= ~IMM_MASK;
-    instr_lo |= (val & IMM_MASK);
-    bfd_put_32 (abfd, instr_lo, bfd_addr + INST_WORD_SIZE);
+    microblaze_put_imm (big_endian, (val >> IMM_SHIFT) & IMM_MASK, bfd_addr);
+    microblaze_put_imm (big_endian, val & IMM_MASK,
+                        bfd_addr + INST_WORD_SIZE);
 }
 
 #define INST_WORD_SIZE 4
@@ -1692,7 +2952,8 @@ static bool is_section_relaxable(asection *sec, struct bfd_link_info *link_info)
         && (sec->flags & SEC_RELOC) != 0
         && (sec->flags & SEC_CODE) != 0
         && sec->reloc_count != 0
-        && sdata != NULL;
+        && sdata != NULL
+        && (!sdata->relax_census || sdata->relax_candidates != 0);
 }
 
 static bool is_reloc_type_relaxable(int r_type)
@@ -1702,32 +2963,39 @@ static bool is_reloc_type_relaxable(int r_type)
         || r_type == R_MICROBLAZE_TEXTREL_64;
 }
 
+/* Section contents read for relaxation come from
+   _bfd_elf_mmap_section_contents.  Where BFD is able to, that maps the
+   input file privately instead of copying it, so a section costs memory
+   only for the pages relaxation actually rewrites.  Contents obtained
+   this way must be released with _bfd_elf_munmap_section_contents,
+   never free; those cached on a section are released the same way by
+   microblaze_elf_release_relaxed_contents once the link is done.
+
+   Return the contents of SEC, setting *FREE_CONTENTS if they were read
+   here and are not yet cached.  */
+
 static bfd_byte *get_section_contents(bfd *abfd, asection *sec, bfd_byte **free_contents)
 {
-    bfd_byte *contents;
+    bfd_byte *contents = NULL;
     
     if (elf_section_data(sec)->this_hdr.contents != NULL) {
         return elf_section_data(sec)->this_hdr.contents;
     }
     
-    contents = (bfd_byte *)bfd_malloc(sec->size);
-    if (contents == NULL) {
+    if (!_bfd_elf_mmap_section_contents(abfd, sec, &contents)) {
         return NULL;
     }
     
     *free_contents = contents;
-    
-    if (!bfd_get_section_contents(abfd, sec, contents, (file_ptr)0, sec->size)) {
-        return NULL;
-    }
-    
-    elf_section_data(sec)->this_hdr.contents = contents;
     return contents;
 }
 
+/* Return the contents of O, another section of the object being
+   relaxed, caching them on O since relaxation is about to patch them.  */
+
 static bfd_byte *get_other_section_contents(bfd *abfd, asection *o)
 {
-    bfd_byte *ocontents;
+    bfd_byte *ocontents = NULL;
     
     if (elf_section_data(o)->this_hdr.contents != NULL) {
         return elf_section_data(o)->this_hdr.contents;
@@ -1737,16 +3005,12 @@ static bfd_byte *get_other_section_contents(bfd *abfd, asection *o)
         o->rawsize = o->size;
     }
     
-    ocontents = (bfd_byte *)bfd_malloc(o->rawsize);
-    if (ocontents == NULL) {
-        return NULL;
-    }
-    
-    if (!bfd_get_section_contents(abfd, o, ocontents, (file_ptr)0, o->rawsize)) {
+    if (!_bfd_elf_mmap_section_contents(abfd, o, &ocontents)) {
         return NULL;
     }
     
     elf_section_data(o)->this_hdr.contents = ocontents;
+    microblaze_elf_section_data(o)->relax_contents_cached = true;
     return ocontents;
 }
 
@@ -1863,6 +3127,10 @@ static bool process_relaxable_reloc(bfd *abfd, asection *sec, Elf_Internal_Rela
         sdata->relax[sdata->relax_count].addr = irel->r_offset;
         sdata->relax[sdata->relax_count].size = INST_WORD_SIZE;
         sdata->relax_count++;
+        sdata->relax_stats.relocs_rewritten++;
+        if (sdata->relax_census) {
+            sdata->relax_candidates--;
+        }
         rewrite_relocation_type(irel);
     }
     
@@ -1920,38 +3188,29 @@ static void update_reloc_in_section(bfd *abfd, asection *sec, Elf_Internal_Rela
     irel->r_offset = nraddr;
 }
 
-static bool handle_r32_reloc(bfd *abfd, asection *o, asection *sec,
-                             Elf_Internal_Rela *irelscan, bfd_byte **ocontents,
-                             Elf_Internal_Sym *isymbuf, unsigned int shndx)
-{
-    Elf_Internal_Sym *isym = isymbuf + ELF32_R_SYM(irelscan->r_info);
-    
-    if (isym->st_shndx == shndx && ELF32_ST_TYPE(isym->st_info) == STT_SECTION) {
-        if (*ocontents == NULL) {
-            *ocontents = get_other_section_contents(abfd, o);
-            if (*ocontents == NULL) {
-                return false;
-            }
-        }
+/* The R_MICROBLAZE_32, R_MICROBLAZE_32_SYM_OP_SYM and R_MICROBLAZE_64
+   fixups below only move the addend, which lives in the reloc, so they
+   never need the contents of the section holding the reloc.  Keeping
+   them apart from the handlers that patch instructions means relocs in
+   .debug_* and other data sections are adjusted without reading those
+   sections at all.  */
+
+static void handle_r32_reloc(asection *sec, Elf_Internal_Rela *irelscan,
+                             Elf_Internal_Sym *isymbuf, unsigned int shndx)
+{
+    Elf_Internal_Sym *isym = isymbuf + ELF32_R_SYM(irelscan->r_info);
+    
+    if (isym->st_shndx == shndx && ELF32_ST_TYPE(isym->st_info) == STT_SECTION) {
         irelscan->r_addend -= calc_fixup(irelscan->r_addend, 0, sec);
     }
-    return true;
 }
 
-static bool handle_r32_sym_op_sym_reloc(bfd *abfd, asection *o, asection *sec,
-                                        Elf_Internal_Rela *irelscan, bfd_byte **ocontents,
+static void handle_r32_sym_op_sym_reloc(asection *sec, Elf_Internal_Rela *irelscan,
                                         Elf_Internal_Sym *isymbuf)
 {
     Elf_Internal_Sym *isym = isymbuf + ELF32_R_SYM(irelscan->r_info);
     
-    if (*ocontents == NULL) {
-        *ocontents = get_other_section_contents(abfd, o);
-        if (*ocontents == NULL) {
-            return false;
-        }
-    }
     irelscan->r_addend -= calc_fixup(irelscan->r_addend + isym->st_value, 0, sec);
-    return true;
 }
 
 static bool handle_lo_reloc(bfd *abfd, asection *o, asection *sec,
@@ -1968,7 +3227,8 @@ static bool handle_lo_reloc(bfd *abfd, asection *o, asection *sec,
             }
         }
         
-        unsigned long instr = bfd_get_32(abfd, *ocontents + irelscan->r_offset);
+        unsigned long instr = microblaze_get_insn(elf32_mb_tdata(abfd)->big_endian,
+                                                  *ocontents + irelscan->r_offset);
         bfd_vma immediate = instr & 0x0000ffff;
         size_t offset = calc_fixup(immediate, 0, sec);
         irelscan->r_addend -= offset;
@@ -1978,23 +3238,14 @@ static bool handle_lo_reloc(bfd *abfd, asection *o, asection *sec,
     return true;
 }
 
-static bool handle_64_reloc(bfd *abfd, asection *o, asection *sec,
-                           Elf_Internal_Rela *irelscan, bfd_byte **ocontents,
-                           Elf_Internal_Sym *isymbuf, unsigned int shndx)
+static void handle_64_reloc(asection *sec, Elf_Internal_Rela *irelscan,
+                            Elf_Internal_Sym *isymbuf, unsigned int shndx)
 {
     Elf_Internal_Sym *isym = isymbuf + ELF32_R_SYM(irelscan->r_info);
     
     if (isym->st_shndx == shndx && ELF32_ST_TYPE(isym->st_info) == STT_SECTION) {
-        if (*ocontents == NULL) {
-            *ocontents = get_other_section_contents(abfd, o);
-            if (*ocontents == NULL) {
-                return false;
-            }
-        }
-        size_t offset = calc_fixup(irelscan->r_addend, 0, sec);
-        irelscan->r_addend -= offset;
+        irelscan->r_addend -= calc_fixup(irelscan->r_addend, 0, sec);
     }
-    return true;
 }
 
 static bool handle_64_pcrel_reloc(bfd *abfd, asection *o, asection *sec,
@@ -2011,8 +3262,12 @@ static bool handle_64_pcrel_reloc(bfd *abfd, asection *o, asection *sec,
             }
         }
         
-        unsigned long instr_hi = bfd_get_32(abfd, *ocontents + irelscan->r_offset);
-        unsigned long instr_lo = bfd_get_32(abfd, *ocontents + irelscan->r_offset + INST_WORD_SIZE);
+        bool big_endian = elf32_mb_tdata(abfd)->big_endian;
+        unsigned long instr_hi = microblaze_get_insn(big_endian,
+                                                     *ocontents + irelscan->r_offset);
+        unsigned long instr_lo = microblaze_get_insn(big_endian,
+                                                     *ocontents + irelscan->r_offset
+                                                     + INST_WORD_SIZE);
         bfd_vma immediate = ((instr_hi & 0x0000ffff) << 16) | (instr_lo & 0x0000ffff);
         size_t offset = calc_fixup(immediate, 0, sec);
         immediate -= offset;
@@ -2022,53 +3277,242 @@ static bool handle_64_pcrel_reloc(bfd *abfd, asection *o, asection *sec,
     return true;
 }
 
-static bool process_other_section_relocs(bfd *abfd, asection *o, asection *sec,
-                                         Elf_Internal_Sym *isymbuf, unsigned int shndx)
+static bool process_other_section_reloc(bfd *abfd, asection *o, asection *sec,
+                                        Elf_Internal_Rela *irelscan, bfd_byte **ocontents,
+                                        Elf_Internal_Sym *isymbuf, unsigned int shndx)
+{
+    int r_type = ELF32_R_TYPE(irelscan->r_info);
+    
+    if (r_type == R_MICROBLAZE_32 || r_type == R_MICROBLAZE_32_NONE) {
+        handle_r32_reloc(sec, irelscan, isymbuf, shndx);
+    } else if (r_type == R_MICROBLAZE_32_SYM_OP_SYM) {
+        handle_r32_sym_op_sym_reloc(sec, irelscan, isymbuf);
+    } else if (r_type == R_MICROBLAZE_32_PCREL_LO ||
+               r_type == R_MICROBLAZE_32_LO ||
+               r_type == R_MICROBLAZE_TEXTREL_32_LO) {
+        return handle_lo_reloc(abfd, o, sec, irelscan, ocontents, isymbuf, shndx);
+    } else if (r_type == R_MICROBLAZE_64 || r_type == R_MICROBLAZE_TEXTREL_64) {
+        handle_64_reloc(sec, irelscan, isymbuf, shndx);
+    } else if (r_type == R_MICROBLAZE_64_PCREL) {
+        return handle_64_pcrel_reloc(abfd, o, sec, irelscan, ocontents, isymbuf, shndx);
+    }
+    
+    return true;
+}
+
+/* Return the ELF index of the section IREL refers to through a local
+   section symbol, or SHN_UNDEF if it does not.  */
+
+static unsigned int section_ref_target(bfd *abfd, Elf_Internal_Rela *irel,
+                                       Elf_Internal_Sym *isymbuf,
+                                       Elf_Internal_Shdr *symtab_hdr)
 {
-    Elf_Internal_Rela *irelocs, *irelscan, *irelscanend;
-    bfd_byte *ocontents = NULL;
+    Elf_Internal_Sym *isym;
+    asection *target;
     
-    if (o == sec || (o->flags & SEC_RELOC) == 0 || o->reloc_count == 0) {
-        return true;
+    if (ELF32_R_SYM(irel->r_info) >= symtab_hdr->sh_info) {
+        return SHN_UNDEF;
     }
     
-    irelocs = _bfd_elf_link_read_relocs(abfd, o, NULL, NULL, true);
-    if (irelocs == NULL) {
+    isym = isymbuf + ELF32_R_SYM(irel->r_info);
+    if (ELF32_ST_TYPE(isym->st_info) != STT_SECTION
+        || isym->st_shndx >= elf_numsections(abfd)) {
+        return SHN_UNDEF;
+    }
+    
+    /* Only code sections with relocs are ever relaxed, so refs to any
+       other section are never looked up.  */
+    target = bfd_section_from_elf_index(abfd, isym->st_shndx);
+    if (target == NULL
+        || (target->flags & (SEC_CODE | SEC_RELOC)) != (SEC_CODE | SEC_RELOC)
+        || target->reloc_count == 0) {
+        return SHN_UNDEF;
+    }
+    
+    return isym->st_shndx;
+}
+
+/* Read the relocs of O for indexing only.  They are cached on O only if
+   they already were; otherwise the caller frees them with
+   free_index_relocs, so sections relaxation never patches, such as most
+   debug sections, do not keep their relocs for the rest of the link.  */
+
+static Elf_Internal_Rela *read_index_relocs(bfd *abfd, asection *o)
+{
+    return _bfd_elf_link_read_relocs(abfd, o, NULL, NULL, false);
+}
+
+static void free_index_relocs(asection *o, Elf_Internal_Rela *irelocs)
+{
+    if (irelocs != elf_section_data(o)->relocs) {
+        free(irelocs);
+    }
+}
+
+/* Build the reverse index of section-symbol references for ABFD.  The
+   index records each reloc by its position, which relaxation does not
+   change, so it stays valid whether the relocs are read afresh or
+   cached later; their types may change, which is why they are
+   dispatched on their type only when applied.  apply_section_refs
+   caches the relocs of a section only once it adjusts one of them,
+   since the adjusted addends must survive until relocate_section.  */
+
+static bool build_section_refs(bfd *abfd, Elf_Internal_Sym *isymbuf,
+                               Elf_Internal_Shdr *symtab_hdr)
+{
+    struct elf32_mb_obj_tdata *tdata = elf32_mb_tdata(abfd);
+    unsigned int numsec = elf_numsections(abfd);
+    size_t *start;
+    size_t nrefs, nsymop = 0;
+    unsigned int i;
+    asection *o;
+    
+    start = (size_t *)bfd_zalloc(abfd, (numsec + 1) * sizeof(*start));
+    if (start == NULL) {
         return false;
     }
     
-    irelscanend = irelocs + o->reloc_count;
-    for (irelscan = irelocs; irelscan < irelscanend; irelscan++) {
-        int r_type = ELF32_R_TYPE(irelscan->r_info);
+    for (o = abfd->sections; o != NULL; o = o->next) {
+        Elf_Internal_Rela *irelocs, *irel, *irelend;
         
-        if (r_type == R_MICROBLAZE_32 || r_type == R_MICROBLAZE_32_NONE) {
-            if (!handle_r32_reloc(abfd, o, sec, irelscan, &ocontents, isymbuf, shndx)) {
-                return false;
-            }
-        } else if (r_type == R_MICROBLAZE_32_SYM_OP_SYM) {
-            if (!handle_r32_sym_op_sym_reloc(abfd, o, sec, irelscan, &ocontents, isymbuf)) {
-                return false;
-            }
-        } else if (r_type == R_MICROBLAZE_32_PCREL_LO ||
-                   r_type == R_MICROBLAZE_32_LO ||
-                   r_type == R_MICROBLAZE_TEXTREL_32_LO) {
-            if (!handle_lo_reloc(abfd, o, sec, irelscan, &ocontents, isymbuf, shndx)) {
-                return false;
+        if ((o->flags & SEC_RELOC) == 0 || o->reloc_count == 0) {
+            continue;
+        }
+        
+        irelocs = read_index_relocs(abfd, o);
+        if (irelocs == NULL) {
+            return false;
+        }
+        
+        irelend = irelocs + o->reloc_count;
+        for (irel = irelocs; irel < irelend; irel++) {
+            if (ELF32_R_TYPE(irel->r_info) == R_MICROBLAZE_32_SYM_OP_SYM) {
+                nsymop++;
+            } else {
+                start[section_ref_target(abfd, irel, isymbuf, symtab_hdr) + 1]++;
             }
-        } else if (r_type == R_MICROBLAZE_64 || r_type == R_MICROBLAZE_TEXTREL_64) {
-            if (!handle_64_reloc(abfd, o, sec, irelscan, &ocontents, isymbuf, shndx)) {
-                return false;
+        }
+        free_index_relocs(o, irelocs);
+    }
+    
+    /* Refs through no section symbol were counted in slot SHN_UNDEF + 1;
+       they are never looked up.  */
+    start[SHN_UNDEF + 1] = 0;
+    for (i = 1; i <= numsec; i++) {
+        start[i] += start[i - 1];
+    }
+    nrefs = start[numsec];
+    
+    tdata->sec_refs = (struct microblaze_sec_ref *)bfd_alloc(abfd, (nrefs + 1) * sizeof(*tdata->sec_refs));
+    tdata->sym_op_sym_refs = (struct microblaze_sec_ref *)bfd_alloc(abfd, (nsymop + 1) * sizeof(*tdata->sym_op_sym_refs));
+    if (tdata->sec_refs == NULL || tdata->sym_op_sym_refs == NULL) {
+        return false;
+    }
+    
+    /* Fill each bucket by bumping its start; afterwards start[i] holds
+       where bucket i + 1 begins, so shifting the array up by one slot
+       restores the bucket starts without a separate fill array.  */
+    for (o = abfd->sections; o != NULL; o = o->next) {
+        Elf_Internal_Rela *irelocs;
+        size_t r;
+        
+        if ((o->flags & SEC_RELOC) == 0 || o->reloc_count == 0) {
+            continue;
+        }
+        
+        irelocs = read_index_relocs(abfd, o);
+        if (irelocs == NULL) {
+            return false;
+        }
+        
+        for (r = 0; r < o->reloc_count; r++) {
+            struct microblaze_sec_ref *ref;
+            unsigned int target;
+            
+            if (ELF32_R_TYPE(irelocs[r].r_info) == R_MICROBLAZE_32_SYM_OP_SYM) {
+                ref = &tdata->sym_op_sym_refs[tdata->sym_op_sym_count++];
+            } else {
+                target = section_ref_target(abfd, irelocs + r, isymbuf, symtab_hdr);
+                if (target == SHN_UNDEF) {
+                    continue;
+                }
+                ref = &tdata->sec_refs[start[target]++];
             }
-        } else if (r_type == R_MICROBLAZE_64_PCREL) {
-            if (!handle_64_pcrel_reloc(abfd, o, sec, irelscan, &ocontents, isymbuf, shndx)) {
+            ref->sec = o;
+            ref->reloc_index = r;
+        }
+        free_index_relocs(o, irelocs);
+    }
+    
+    memmove(start + 1, start, numsec * sizeof(*start));
+    start[0] = 0;
+    tdata->sec_ref_start = start;
+    return true;
+}
+
+static bool apply_section_refs(bfd *abfd, asection *sec,
+                               struct microblaze_sec_ref *ref,
+                               struct microblaze_sec_ref *refend,
+                               Elf_Internal_Sym *isymbuf, unsigned int shndx)
+{
+    asection *o = NULL;
+    Elf_Internal_Rela *irelocs = NULL;
+    bfd_byte *ocontents = NULL;
+    
+    for (; ref < refend; ref++) {
+        if (ref->sec == sec) {
+            continue;
+        }
+        
+        if (ref->sec != o) {
+            o = ref->sec;
+            ocontents = NULL;
+            irelocs = _bfd_elf_link_read_relocs(abfd, o, NULL, NULL, true);
+            if (irelocs == NULL) {
                 return false;
             }
         }
+        
+        if (!process_other_section_reloc(abfd, o, sec, irelocs + ref->reloc_index,
+                                         &ocontents, isymbuf, shndx)) {
+            return false;
+        }
+        microblaze_elf_section_data(o)->relax_relocs_cached = true;
+        microblaze_elf_section_data(sec)->relax_stats.other_relocs_patched++;
     }
     
     return true;
 }
 
+/* Adjust the relocs in other sections of ABFD that refer to SEC, which
+   is about to shrink.  Only the relocs recorded against SEC in the
+   reverse index are visited.  */
+
+static bool process_other_section_relocs(bfd *abfd, asection *sec,
+                                         Elf_Internal_Sym *isymbuf,
+                                         Elf_Internal_Shdr *symtab_hdr,
+                                         unsigned int shndx)
+{
+    struct elf32_mb_obj_tdata *tdata = elf32_mb_tdata(abfd);
+    
+    if (tdata->sec_ref_start == NULL
+        && !build_section_refs(abfd, isymbuf, symtab_hdr)) {
+        return false;
+    }
+    
+    if (shndx != SHN_UNDEF && shndx < elf_numsections(abfd)
+        && !apply_section_refs(abfd, sec,
+                               tdata->sec_refs + tdata->sec_ref_start[shndx],
+                               tdata->sec_refs + tdata->sec_ref_start[shndx + 1],
+                               isymbuf, shndx)) {
+        return false;
+    }
+    
+    return apply_section_refs(abfd, sec, tdata->sym_op_sym_refs,
+                              tdata->sym_op_sym_refs + tdata->sym_op_sym_count,
+                              isymbuf, shndx);
+}
+
 static void adjust_local_symbols(Elf_Internal_Sym *isymbuf, Elf_Internal_Shdr *symtab_hdr,
                                  unsigned int shndx, asection *sec)
 {
@@ -2105,40 +3549,202 @@ static void adjust_global_symbols(bfd *abfd, Elf_Internal_Shdr *symtab_hdr, asec
     }
 }
 
+/* Runs of kept code at most this long are copied a word at a time
+   rather than through memmove.  */
+#define RELAX_SHORT_RUN 64
+
+/* Squeeze the bytes recorded in the relax table out of SEC's contents.
+   The kept runs are copied down in a single forward sweep: each run
+   moves by the number of bytes deleted before it, so copying in address
+   order never overwrites bytes that have yet to be moved.  When every
+   deletion is a whole aligned word, as it is for deleted imm
+   instructions, every run is a whole number of words and moves down by
+   at least a word.  Copying a short run word by word, in address order,
+   then never reads a word after it has been overwritten, and saves a
+   memmove call for each of the many short runs between imm words.  */
+
 static void physically_move_code(bfd_byte *contents, asection *sec,
                                  struct _microblaze_elf_section_data *sdata)
 {
-    bfd_vma dest = sdata->relax[0].addr;
+    struct relax_table *relax = sdata->relax;
+    size_t count = sdata->relax_count;
+    bfd_byte *dest = contents + relax[0].addr;
+    bool word_granular = (relax[count].addr & (INST_WORD_SIZE - 1)) == 0;
     size_t i;
     
-    for (i = 0; i < sdata->relax_count; i++) {
-        size_t len;
-        bfd_vma src = sdata->relax[i].addr + sdata->relax[i].size;
-        len = sdata->relax[i + 1].addr - sdata->relax[i].addr - sdata->relax[i].size;
+    for (i = 0; i < count && word_granular; i++) {
+        word_granular = (relax[i].size == INST_WORD_SIZE
+                         && (relax[i].addr & (INST_WORD_SIZE - 1)) == 0);
+    }
+    
+    for (i = 0; i < count; i++) {
+        const bfd_byte *src = contents + relax[i].addr + relax[i].size;
+        size_t len = relax[i + 1].addr - relax[i].addr - relax[i].size;
         
-        memmove(contents + dest, contents + src, len);
-        sec->size -= sdata->relax[i].size;
+        if (word_granular && len <= RELAX_SHORT_RUN) {
+            size_t k;
+            
+            for (k = 0; k < len; k += INST_WORD_SIZE) {
+                memcpy(dest + k, src + k, INST_WORD_SIZE);
+            }
+        } else {
+            memmove(dest, src, len);
+        }
         dest += len;
     }
+    
+    if (sec->rawsize == 0) {
+        sec->rawsize = sec->size;
+    }
+    if (sdata->relax_orig_size == 0) {
+        sdata->relax_orig_size = sec->size;
+    }
+    sec->size -= relax[count].cum_size;
+}
+
+static int compare_relax_entries(const void *a, const void *b)
+{
+    const struct relax_table *ra = (const struct relax_table *)a;
+    const struct relax_table *rb = (const struct relax_table *)b;
+
+    if (ra->addr < rb->addr) {
+        return -1;
+    }
+    return ra->addr > rb->addr;
+}
+
+/* Sort the relax table by address, terminate it with a sentinel at the
+   end of the section and record the running total of deleted bytes in
+   each entry.  calc_fixup then answers every query with a binary search
+   instead of walking the table.  */
+
+static void build_relax_map(asection *sec, struct _microblaze_elf_section_data *sdata)
+{
+    size_t cum_size = 0;
+    size_t i;
+
+    for (i = 1; i < sdata->relax_count; i++) {
+        if (sdata->relax[i].addr < sdata->relax[i - 1].addr) {
+            qsort(sdata->relax, sdata->relax_count, sizeof(*sdata->relax),
+                  compare_relax_entries);
+            break;
+        }
+    }
+
+    sdata->relax[sdata->relax_count].addr = sec->size;
+    sdata->relax[sdata->relax_count].size = 0;
+
+    for (i = 0; i <= sdata->relax_count; i++) {
+        sdata->relax[i].cum_size = cum_size;
+        cum_size += sdata->relax[i].size;
+    }
+}
+
+/* Delete the imm words recorded in SDATA->relax from SEC, and adjust
+   relocs, symbols and other sections' references accordingly.  */
+
+static bool relax_delete_bytes(bfd *abfd, asection *sec,
+                               struct _microblaze_elf_section_data *sdata,
+                               Elf_Internal_Rela *internal_relocs,
+                               bfd_byte *contents, Elf_Internal_Sym *isymbuf,
+                               Elf_Internal_Shdr *symtab_hdr)
+{
+    Elf_Internal_Rela *irel, *irelend;
+    unsigned int shndx;
+
+    shndx = _bfd_elf_section_from_bfd_section(abfd, sec);
+    build_relax_map(sec, sdata);
+
+    irelend = internal_relocs + sec->reloc_count;
+    for (irel = internal_relocs; irel < irelend; irel++) {
+        update_reloc_in_section(abfd, sec, irel, contents, isymbuf, symtab_hdr, shndx);
+    }
+
+    if (!process_other_section_relocs(abfd, sec, isymbuf, symtab_hdr, shndx)) {
+        return false;
+    }
+
+    adjust_local_symbols(isymbuf, symtab_hdr, shndx, sec);
+    adjust_global_symbols(abfd, symtab_hdr, sec);
+    physically_move_code(contents, sec, sdata);
+    sdata->relax_stats.imm_deleted += sdata->relax_count;
+    sdata->relax_stats.bytes_saved += sdata->relax[sdata->relax_count].cum_size;
+    return true;
+}
+
+/* Return room for COUNT relax table entries, or NULL on failure.  The
+   table is only needed while relax_section runs, so every section uses
+   the same one; it grows to the largest section seen and is kept until
+   the hash table is freed.  */
+
+static struct relax_table *
+get_relax_buf(struct elf32_mb_link_hash_table *htab, size_t count)
+{
+    if (count > htab->relax_buf_alloc) {
+        size_t alloc = 2 * htab->relax_buf_alloc;
+        struct relax_table *buf;
+        
+        if (alloc < count) {
+            alloc = count;
+        }
+        buf = (struct relax_table *)bfd_realloc(htab->relax_buf,
+                                                alloc * sizeof(*buf));
+        if (buf == NULL) {
+            return NULL;
+        }
+        htab->relax_buf = buf;
+        htab->relax_buf_alloc = alloc;
+        htab->relax_buf_grows++;
+    }
+    return htab->relax_buf;
+}
+
+/* Return a wall clock reading in microseconds, for timing relaxation.
+   Hosts without a monotonic clock fall back to processor time, which
+   leaves out time spent waiting on I/O such as paging in contents.  */
+
+static long
+microblaze_relax_clock (void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+
+  if (clock_gettime (CLOCK_MONOTONIC, &ts) == 0)
+    return (long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+  return get_run_time ();
 }
 
+/* Relax SEC to a local fixpoint.  Each round only re-examines the
+   R_MICROBLAZE_64, R_MICROBLAZE_64_PCREL and R_MICROBLAZE_TEXTREL_64
+   sites that are still unrelaxed, reusing the relocs, contents and
+   symbols read by the first round.  Deleting bytes can only bring
+   targets closer, so rounds continue until nothing more shrinks.
+   *AGAIN is still set when anything was deleted, because sites in other
+   sections may now reach into SEC.  SEC records the generation it was
+   scanned at, not counting its own deletions, so a later pass skips it
+   only when no section at all, SEC included, has shrunk since; after a
+   shrink its sites are checked again against the new layout.  */
+
 static bool
 microblaze_elf_relax_section(bfd *abfd,
                              asection *sec,
                              struct bfd_link_info *link_info,
                              bool *again)
 {
+    struct elf32_mb_link_hash_table *htab;
     Elf_Internal_Shdr *symtab_hdr;
     Elf_Internal_Rela *internal_relocs;
     Elf_Internal_Rela *free_relocs = NULL;
     Elf_Internal_Rela *irel, *irelend;
     bfd_byte *contents = NULL;
     bfd_byte *free_contents = NULL;
-    unsigned int shndx;
     Elf_Internal_Sym *isymbuf;
     size_t symcount;
     struct _microblaze_elf_section_data *sdata;
-    asection *o;
+    unsigned int generation;
+    bool timed;
+    long start = 0;
     
     *again = false;
     
@@ -2146,7 +3752,21 @@ microblaze_elf_relax_section(bfd *abfd,
         return true;
     }
     
+    htab = elf32_mb_hash_table(link_info);
+    if (htab == NULL) {
+        return false;
+    }
+    
+    htab->relax_calls++;
     sdata = microblaze_elf_section_data(sec);
+    if (sdata->relax_generation == htab->relax_generation) {
+        htab->relax_skipped++;
+        return true;
+    }
+    sdata->relax_stats.calls++;
+    generation = htab->relax_generation;
+    timed = htab->params.relax_stats != NULL;
+    
     BFD_ASSERT((sec->size > 0) || (sec->rawsize > 0));
     
     if (sec->size == 0) {
@@ -2167,51 +3787,72 @@ microblaze_elf_relax_section(bfd *abfd,
         goto error_return;
     }
     
-    if (!link_info->keep_memory) {
+    if (!link_info->keep_memory && internal_relocs != elf_section_data(sec)->relocs) {
         free_relocs = internal_relocs;
     }
     
+    /* Each entry comes from a distinct relaxable reloc, plus one for the
+       sentinel added by build_relax_map.  */
     sdata->relax_count = 0;
-    sdata->relax = (struct relax_table *)bfd_malloc((sec->reloc_count + 1) * sizeof(*sdata->relax));
+    sdata->relax = get_relax_buf(htab, (sdata->relax_census
+                                        ? sdata->relax_candidates
+                                        : sec->reloc_count) + 1);
     if (sdata->relax == NULL) {
         goto error_return;
     }
     
     irelend = internal_relocs + sec->reloc_count;
-    for (irel = internal_relocs; irel < irelend; irel++) {
-        if (!is_reloc_type_relaxable(ELF32_R_TYPE(irel->r_info))) {
-            continue;
+    for (;;) {
+        sdata->relax_stats.rounds++;
+        if (timed) {
+            start = microblaze_relax_clock();
         }
-        
-        if (!process_relaxable_reloc(abfd, sec, irel, sdata, &contents, 
-                                     &free_contents, isymbuf, symtab_hdr)) {
-            goto error_return;
+        sdata->relax_count = 0;
+        for (irel = internal_relocs; irel < irelend; irel++) {
+            if (!is_reloc_type_relaxable(ELF32_R_TYPE(irel->r_info))) {
+                continue;
+            }
+            
+            if (!process_relaxable_reloc(abfd, sec, irel, sdata, &contents, 
+                                         &free_contents, isymbuf, symtab_hdr)) {
+                goto error_return;
+            }
         }
-    }
-    
-    if (sdata->relax_count > 0) {
-        shndx = _bfd_elf_section_from_bfd_section(abfd, sec);
-        sdata->relax[sdata->relax_count].addr = sec->size;
         
-        for (irel = internal_relocs; irel < irelend; irel++) {
-            update_reloc_in_section(abfd, sec, irel, contents, isymbuf, symtab_hdr, shndx);
+        if (timed) {
+            sdata->relax_stats.scan_time += microblaze_relax_clock() - start;
         }
         
-        for (o = abfd->sections; o != NULL; o = o->next) {
-            if (!process_other_section_relocs(abfd, o, sec, isymbuf, shndx)) {
-                goto error_return;
-            }
+        if (sdata->relax_count == 0) {
+            break;
         }
         
-        adjust_local_symbols(isymbuf, symtab_hdr, shndx, sec);
-        adjust_global_symbols(abfd, symtab_hdr, sec);
-        physically_move_code(contents, sec, sdata);
+        if (timed) {
+            start = microblaze_relax_clock();
+        }
+        if (!relax_delete_bytes(abfd, sec, sdata, internal_relocs, contents,
+                                isymbuf, symtab_hdr)) {
+            goto error_return;
+        }
+        if (timed) {
+            sdata->relax_stats.delete_time += microblaze_relax_clock() - start;
+        }
         
         elf_section_data(sec)->relocs = internal_relocs;
+        sdata->relax_relocs_cached = true;
         free_relocs = NULL;
         elf_section_data(sec)->this_hdr.contents = contents;
-        free_contents = NULL;
-        symtab_hdr->contents = (bfd_byte *)isymbuf;
+        if (free_contents != NULL) {
+            sdata->relax_contents_cached = true;
+            free_contents = NULL;
+        }
+        if (symtab_hdr->contents != (bfd_byte *)isymbuf) {
+            symtab_hdr->contents = (bfd_byte *)isymbuf;
+            elf32_mb_tdata(abfd)->relax_syms_cached = true;
+        }
+        
+        htab->relax_generation++;
+        *again = true;
     }
     
     free(free_relocs);
@@ -2219,27 +3860,22 @@ microblaze_elf_relax_section(bfd *abfd,
     
     if (free_contents != NULL) {
         if (!link_info->keep_memory) {
-            free(free_contents);
+            _bfd_elf_munmap_section_contents(sec, free_contents);
         } else {
             elf_section_data(sec)->this_hdr.contents = contents;
+            sdata->relax_contents_cached = true;
         }
         free_contents = NULL;
     }
     
-    if (sdata->relax_count == 0) {
-        *again = false;
-        free(sdata->relax);
-        sdata->relax = NULL;
-    } else {
-        *again = true;
-    }
+    sdata->relax = NULL;
+    sdata->relax_generation = generation;
     
     return true;
     
 error_return:
     free(free_relocs);
-    free(free_contents);
-    free(sdata->relax);
+    _bfd_elf_munmap_section_contents(sec, free_contents);
     sdata->relax = NULL;
     sdata->relax_count = 0;
     return false;
@@ -2275,6 +3911,22 @@ microblaze_elf_gc_mark_hook (asection *sec,
 #define PLT_ENTRY_WORD_2  0x98186000	      /* "brad r12".  */
 #define PLT_ENTRY_WORD_3  0x80000000	      /* "nop".  */
 
+/* With lazy binding each entry is followed by a tail that the entry's
+   .got.plt slot initially points at.  The tail passes the offset of
+   the entry's JUMP_SLOT reloc to PLT0, which calls the resolver in
+   .got.plt[2] with the link map from .got.plt[1].  */
+#define LAZY_PLT_ENTRY_SIZE 32
+
+#define LAZY_PLT_ENTRY_WORD_4	0xb0000000    /* "imm 0".  */
+#define LAZY_PLT_ENTRY_WORD_5	0x30600000    /* "addik r3,r0,0" - reloc offset.  */
+#define LAZY_PLT_ENTRY_WORD_6	0xb0000000    /* "imm 0".  */
+#define LAZY_PLT_ENTRY_WORD_7	0xb8000000    /* "bri 0" - to PLT0.  */
+
+#define LAZY_PLT0_WORD_1	0xe8940000    /* "lwi r4,r20,0" - .got.plt[1].  */
+#define LAZY_PLT0_WORD_1_NOPIC	0xe8800000    /* "lwi r4,r0,0".  */
+#define LAZY_PLT0_WORD_3	0xe9940000    /* "lwi r12,r20,0" - .got.plt[2].  */
+#define LAZY_PLT0_WORD_3_NOPIC	0xe9800000    /* "lwi r12,r0,0".  */
+
 static bool allocate_local_got_arrays(bfd *abfd, Elf_Internal_Shdr *symtab_hdr)
 {
     bfd_size_type size = symtab_hdr->sh_info;
@@ -2380,6 +4032,13 @@ handle_plt_relocation(struct elf_link_hash_entry *h)
 {
   if (h != NULL)
   {
+    /* A call to a hidden or internal symbol always binds within the
+       output, so it goes straight to the function.  */
+    if (h->forced_local
+        || ELF_ST_VISIBILITY(h->other) == STV_HIDDEN
+        || ELF_ST_VISIBILITY(h->other) == STV_INTERNAL)
+      return;
+    
     h->needs_plt = 1;
     h->plt.refcount += 1;
   }
@@ -2497,17 +4156,18 @@ static struct elf_dyn_relocs *
 allocate_dynrelocs_entry(struct elf32_mb_link_hash_table *htab,
                          asection *sec)
 {
-  size_t amt = sizeof(struct elf_dyn_relocs);
-  struct elf_dyn_relocs *p = bfd_alloc(htab->elf.dynobj, amt);
-  
-  if (p != NULL)
-  {
-    p->sec = sec;
-    p->count = 0;
-    p->pc_count = 0;
-  }
+  size_t amt = sizeof(struct elf32_mb_dyn_relocs);
+  struct elf32_mb_dyn_relocs *mp = bfd_alloc(htab->elf.dynobj, amt);
   
-  return p;
+  if (mp == NULL)
+    return NULL;
+    
+  mp->root.sec = sec;
+  mp->root.count = 0;
+  mp->root.pc_count = 0;
+  mp->rel_index = 0;
+  mp->emitted = 0;
+  return &mp->root;
 }
 
 static bool
@@ -2541,15 +4201,26 @@ handle_direct_relocation(struct elf32_mb_link_hash_table *htab,
                          struct bfd_link_info *info,
                          asection *sec,
                          struct elf_link_hash_entry *h,
-                         unsigned long r_symndx,
-                         unsigned int r_type,
+                         const Elf_Internal_Rela *rel,
                          asection **sreloc)
 {
+  unsigned long r_symndx = ELF32_R_SYM(rel->r_info);
+  unsigned int r_type = ELF32_R_TYPE(rel->r_info);
+  
   update_hash_entry_for_direct_reloc(h, info, r_type);
   
   if (!needs_dynamic_relocation(info, sec, r_type, h))
     return true;
     
+  /* A word against a local symbol is a plain relative reloc; reserve
+     a .relr.dyn word for it instead of a .rela.dyn entry.  */
+  if (h == NULL
+      && microblaze_elf_relr_reloc_p(info, htab, sec, r_type, rel->r_offset))
+  {
+    microblaze_elf_section_data(sec)->relr_count += 1;
+    return true;
+  }
+    
   if (*sreloc == NULL)
   {
     *sreloc = create_dynamic_reloc_section(htab, abfd, sec);
@@ -2573,20 +4244,84 @@ handle_direct_relocation(struct elf32_mb_link_hash_table *htab,
   return add_dynamic_relocation(htab, head, sec, r_type);
 }
 
+/* Return the contents of SEC for inspecting instruction sequences,
+   mapping them into *BUF unless they are already cached.  */
+
+static bfd_byte *
+get_check_relocs_contents(bfd *abfd, asection *sec, bfd_byte **buf)
+{
+  if (elf_section_data(sec)->this_hdr.contents != NULL)
+    return elf_section_data(sec)->this_hdr.contents;
+    
+  if (*buf == NULL && !_bfd_elf_mmap_section_contents(abfd, sec, buf))
+    return NULL;
+    
+  return *buf;
+}
+
+/* Return true if local symbol R_SYMNDX of ABFD is absolute.  */
+
+static bool
+local_symbol_absolute_p(struct elf32_mb_link_hash_table *htab,
+                        bfd *abfd,
+                        unsigned long r_symndx)
+{
+  Elf_Internal_Sym *isym = bfd_sym_from_r_symndx(&htab->elf.sym_cache,
+                                                  abfd, r_symndx);
+  
+  return isym != NULL && isym->st_shndx == SHN_ABS;
+}
+
+/* Decide how the TLS GD or LD sequence at REL will be relaxed.  This
+   must agree with relocate_section, which repeats the test once
+   symbols are resolved and may relax a global further, to LE.  */
+
+static enum microblaze_tls_model
+check_tls_gd_ld_transition(bfd *abfd,
+                           struct bfd_link_info *info,
+                           asection *sec,
+                           const Elf_Internal_Rela *rel,
+                           const Elf_Internal_Rela *rel_end,
+                           Elf_Internal_Shdr *symtab_hdr,
+                           struct elf_link_hash_entry **sym_hashes,
+                           struct elf_link_hash_entry *h,
+                           bfd_byte **contents)
+{
+  unsigned int r_type = ELF32_R_TYPE(rel->r_info);
+  enum microblaze_tls_model model = microblaze_tls_transition(info, r_type, h, false);
+  bfd_byte *buf;
+  
+  if (model == TLS_MODEL_NONE)
+    return model;
+    
+  buf = get_check_relocs_contents(abfd, sec, contents);
+  if (buf == NULL
+      || !tls_gd_ld_sequence_p(elf32_mb_tdata(abfd)->big_endian, buf,
+                               sec->size, rel,
+                               find_tls_get_addr_call(rel, rel_end, symtab_hdr,
+                                                      sym_hashes)))
+    return TLS_MODEL_NONE;
+    
+  return model;
+}
+
 static bool
 process_relocation(struct elf32_mb_link_hash_table *htab,
                    bfd *abfd,
                    struct bfd_link_info *info,
                    asection *sec,
                    const Elf_Internal_Rela *rel,
+                   const Elf_Internal_Rela *rel_end,
                    Elf_Internal_Shdr *symtab_hdr,
                    struct elf_link_hash_entry **sym_hashes,
-                   asection **sreloc)
+                   asection **sreloc,
+                   bfd_byte **contents)
 {
   unsigned long r_symndx = ELF32_R_SYM(rel->r_info);
   unsigned int r_type = ELF32_R_TYPE(rel->r_info);
   struct elf_link_hash_entry *h = get_hash_entry(sym_hashes, r_symndx, symtab_hdr);
   unsigned char tls_type = 0;
+  bfd_byte *buf;
   
   switch (r_type)
   {
@@ -2601,16 +4336,58 @@ process_relocation(struct elf32_mb_link_hash_table *htab,
       break;
       
     case R_MICROBLAZE_TLSGD:
-      tls_type = TLS_TLS | TLS_GD;
+    case R_MICROBLAZE_TLSLD:
+      switch (check_tls_gd_ld_transition(abfd, info, sec, rel, rel_end,
+                                         symtab_hdr, sym_hashes, h, contents))
+      {
+        case TLS_MODEL_LE:
+          /* No GOT entry; the offset is known at link time.  */
+          sec->has_tls_reloc = 1;
+          return true;
+        case TLS_MODEL_IE:
+          tls_type = TLS_TLS | TLS_TPREL;
+          break;
+        default:
+          tls_type = TLS_TLS | (r_type == R_MICROBLAZE_TLSGD ? TLS_GD : TLS_LD);
+          break;
+      }
       return handle_got_relocation(htab, abfd, info, sec, h, r_symndx,
                                    symtab_hdr, tls_type);
       
-    case R_MICROBLAZE_TLSLD:
-      tls_type = TLS_TLS | TLS_LD;
+    case R_MICROBLAZE_TLSGOTTPREL32:
+      tls_type = TLS_TLS | TLS_TPREL;
+      if (microblaze_tls_transition(info, r_type, h, false) != TLS_MODEL_NONE)
+      {
+        buf = get_check_relocs_contents(abfd, sec, contents);
+        if (buf == NULL
+            || !tls_imm_pair_p(elf32_mb_tdata(abfd)->big_endian, buf,
+                               sec->size, rel->r_offset, INST_LWI))
+          tls_type |= TLS_TPREL_NORELAX;
+        else if (h == NULL)
+        {
+          sec->has_tls_reloc = 1;
+          return true;
+        }
+      }
       return handle_got_relocation(htab, abfd, info, sec, h, r_symndx,
                                    symtab_hdr, tls_type);
       
+    case R_MICROBLAZE_TLSTPREL32:
+      sec->has_tls_reloc = 1;
+      break;
+      
     case R_MICROBLAZE_GOT_64:
+      buf = get_check_relocs_contents(abfd, sec, contents);
+      if (buf != NULL
+          && tls_imm_pair_p(elf32_mb_tdata(abfd)->big_endian, buf,
+                            sec->size, rel->r_offset, INST_LWI))
+      {
+        if (h != NULL)
+          elf32_mb_hash_entry(h)->gotoff_refcount += 1;
+        else if (!local_symbol_absolute_p(htab, abfd, r_symndx)
+                 || !bfd_link_pic(info))
+          return handle_gotoff_relocation(htab, abfd, info);
+      }
       return handle_got_relocation(htab, abfd, info, sec, h, r_symndx,
                                    symtab_hdr, tls_type);
       
@@ -2618,13 +4395,79 @@ process_relocation(struct elf32_mb_link_hash_table *htab,
     case R_MICROBLAZE_GOTOFF_32:
       return handle_gotoff_relocation(htab, abfd, info);
       
-    case R_MICROBLAZE_64:
-    case R_MICROBLAZE_64_PCREL:
-    case R_MICROBLAZE_32:
-      return handle_direct_relocation(htab, abfd, info, sec, h, r_symndx,
-                                      r_type, sreloc);
+    case R_MICROBLAZE_64:
+    case R_MICROBLAZE_64_PCREL:
+    case R_MICROBLAZE_32:
+      return handle_direct_relocation(htab, abfd, info, sec, h, rel, sreloc);
+  }
+  
+  return true;
+}
+
+/* Forget what an earlier link in this process recorded for ABFD, which
+   is being added to a new link.  This runs before any of its relocs are
+   checked.  The relax generation in particular is only meaningful
+   against the hash table that set it, and the dynamic reloc counts and
+   sections belong to the earlier link's dynobj.  Relocs, contents and
+   symbols that relaxation rewrote and left cached are dropped, so that
+   they are read afresh from the file, and sections it shrank get their
+   size back; anything cached by other code is left alone.  */
+
+static bool
+microblaze_elf_before_check_relocs(bfd *abfd, struct bfd_link_info *info)
+{
+  struct elf32_mb_obj_tdata *tdata = elf32_mb_tdata(abfd);
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata(abfd)->symtab_hdr;
+  asection *sec;
+  
+  if (bfd_link_relocatable(info) || elf32_mb_hash_table(info) == NULL)
+    return true;
+  
+  for (sec = abfd->sections; sec != NULL; sec = sec->next)
+  {
+    struct _microblaze_elf_section_data *sdata = microblaze_elf_section_data(sec);
+    
+    if (sdata->relax_relocs_cached)
+    {
+      free(sdata->elf.relocs);
+      sdata->elf.relocs = NULL;
+      sdata->relax_relocs_cached = false;
+    }
+    if (sdata->relax_contents_cached)
+    {
+      bfd_byte *contents = sdata->elf.this_hdr.contents;
+      
+      sdata->elf.this_hdr.contents = NULL;
+      sdata->relax_contents_cached = false;
+      _bfd_elf_munmap_section_contents(sec, contents);
+    }
+    if (sdata->relax_orig_size != 0)
+    {
+      sec->size = sdata->relax_orig_size;
+      sdata->relax_orig_size = 0;
+    }
+    sdata->elf.local_dynrel = NULL;
+    sdata->elf.sreloc = NULL;
+    sdata->relax_generation = 0;
+    sdata->relr_count = 0;
+    memset(&sdata->relax_stats, 0, sizeof (sdata->relax_stats));
+    /* Until check_relocs counts the section's candidates afresh, the
+       earlier link's count does not apply.  */
+    sdata->relax_census = false;
   }
   
+  if (tdata->relax_syms_cached)
+  {
+    free(symtab_hdr->contents);
+    symtab_hdr->contents = NULL;
+    tdata->relax_syms_cached = false;
+  }
+  tdata->sec_ref_start = NULL;
+  tdata->sec_refs = NULL;
+  tdata->sym_op_sym_refs = NULL;
+  tdata->sym_op_sym_count = 0;
+  tdata->local_got_rel_index = NULL;
+  elf_local_got_refcounts(abfd) = NULL;
   return true;
 }
 
@@ -2644,17 +4487,30 @@ microblaze_elf_check_relocs(bfd *abfd,
   Elf_Internal_Shdr *symtab_hdr = &elf_tdata(abfd)->symtab_hdr;
   struct elf_link_hash_entry **sym_hashes = elf_sym_hashes(abfd);
   asection *sreloc = NULL;
+  bfd_byte *contents = NULL;
+  bool ok = true;
+  struct _microblaze_elf_section_data *sdata = microblaze_elf_section_data(sec);
+  
+  /* Count the relocs relaxation could shorten, for sizing its table.  */
+  sdata->relax_candidates = 0;
+  sdata->relax_census = true;
   
   const Elf_Internal_Rela *rel_end = relocs + sec->reloc_count;
   
   for (const Elf_Internal_Rela *rel = relocs; rel < rel_end; rel++)
   {
-    if (!process_relocation(htab, abfd, info, sec, rel, symtab_hdr,
-                           sym_hashes, &sreloc))
-      return false;
+    if (is_reloc_type_relaxable(ELF32_R_TYPE(rel->r_info)))
+      sdata->relax_candidates++;
+    if (!process_relocation(htab, abfd, info, sec, rel, rel_end, symtab_hdr,
+                           sym_hashes, &sreloc, &contents))
+    {
+      ok = false;
+      break;
+    }
   }
   
-  return true;
+  _bfd_elf_munmap_section_contents(sec, contents);
+  return ok;
 }
 
 /* Copy the extra info we tack onto an elf_link_hash_entry.  */
@@ -2670,6 +4526,8 @@ microblaze_elf_copy_indirect_symbol (struct bfd_link_info *info,
   eind = (struct elf32_mb_link_hash_entry *) ind;
 
   edir->tls_mask |= eind->tls_mask;
+  edir->gotoff_refcount += eind->gotoff_refcount;
+  eind->gotoff_refcount = 0;
 
   _bfd_elf_link_hash_copy_indirect (info, dir, ind);
 }
@@ -2821,7 +4679,6 @@ microblaze_elf_adjust_dynamic_symbol(struct bfd_link_info *info,
 /* Allocate space in .plt, .got and associated reloc sections for
    dynamic relocs.  */
 
-#define PLT_ENTRY_SIZE_VALUE 12
 #define GOT_ENTRY_SIZE 4
 #define RELA_SIZE sizeof(Elf32_External_Rela)
 #define TLS_ENTRY_SIZE 8
@@ -2838,6 +4695,15 @@ ensure_dynamic_symbol(struct bfd_link_info *info, struct elf_link_hash_entry *h)
   return true;
 }
 
+/* Return the size of a PLT entry, and of the reserved PLT0, in the
+   layout selected for this link.  */
+
+static bfd_vma
+plt_entry_size(struct elf32_mb_link_hash_table *htab)
+{
+  return htab->params.lazy_plt ? LAZY_PLT_ENTRY_SIZE : PLT_ENTRY_SIZE;
+}
+
 static void
 reset_plt_entry(struct elf_link_hash_entry *h)
 {
@@ -2853,7 +4719,7 @@ allocate_plt_entry(struct elf_link_hash_entry *h,
   asection *s = htab->elf.splt;
   
   if (s->size == 0)
-    s->size = PLT_ENTRY_SIZE_VALUE;
+    s->size = plt_entry_size(htab);
   
   h->plt.offset = s->size;
   
@@ -2863,7 +4729,7 @@ allocate_plt_entry(struct elf_link_hash_entry *h,
       h->root.u.def.value = h->plt.offset;
     }
   
-  s->size += PLT_ENTRY_SIZE_VALUE;
+  s->size += plt_entry_size(htab);
   htab->elf.sgotplt->size += GOT_ENTRY_SIZE;
   htab->elf.srelplt->size += RELA_SIZE;
   
@@ -2894,6 +4760,7 @@ process_plt_allocation(struct elf_link_hash_entry *h,
 
 static unsigned int
 calculate_tls_need(struct elf32_mb_link_hash_entry *eh,
+                   struct bfd_link_info *info,
                    struct elf32_mb_link_hash_table *htab)
 {
   unsigned int need = 0;
@@ -2907,10 +4774,47 @@ calculate_tls_need(struct elf32_mb_link_hash_entry *eh,
     }
   if ((eh->tls_mask & TLS_GD) != 0)
     need += TLS_ENTRY_SIZE;
+  /* IE accesses to a symbol that turned out to bind locally in an
+     executable are all relaxed to LE and need no GOT slot.  */
+  if ((eh->tls_mask & TLS_TPREL) != 0
+      && ((eh->tls_mask & TLS_TPREL_NORELAX) != 0
+          || microblaze_tls_transition(info, R_MICROBLAZE_TLSGOTTPREL32,
+                                       &eh->elf, true) != TLS_MODEL_LE))
+    need += GOT_ENTRY_SIZE;
   
   return need;
 }
 
+/* Return how many .rela.got relocs the GOT entry of EH, NEED bytes
+   long, will have.  This follows the choices apply_got_entry_reloc and
+   finish_dynamic_symbol make: a TLS entry has a reloc for each word
+   when its relocs are needed at all, and a plain entry has a relative
+   reloc in a PIC link or a GLOB_DAT reloc if it refers to a dynamic
+   symbol.  The words of an LD entry of a symbol that was defined
+   dynamically are never referenced, relocate_section using the
+   module's LD entry instead.  */
+
+static unsigned int
+got_entry_reloc_count(struct elf32_mb_link_hash_entry *eh,
+                      struct bfd_link_info *info, unsigned int need)
+{
+  struct elf_link_hash_entry *h = &eh->elf;
+  unsigned long indx = get_symbol_index(info, h);
+  
+  if ((eh->tls_mask & TLS_TLS) == 0)
+    return (bfd_link_pic(info) || indx != 0) ? 1 : 0;
+  
+  if (!((bfd_link_pic(info) || indx != 0)
+        && ((ELF_ST_VISIBILITY(h->other) == STV_DEFAULT
+             && !UNDEFWEAK_NO_DYNAMIC_RELOC(info, h))
+            || h->root.type != bfd_link_hash_undefweak)))
+    return 0;
+  
+  if ((eh->tls_mask & TLS_LD) != 0 && h->def_dynamic)
+    need -= TLS_ENTRY_SIZE;
+  return need / GOT_ENTRY_SIZE;
+}
+
 static bool
 allocate_got_entry(struct elf_link_hash_entry *h,
                    struct bfd_link_info *info,
@@ -2924,7 +4828,7 @@ allocate_got_entry(struct elf_link_hash_entry *h,
     return false;
   
   if ((eh->tls_mask & TLS_TLS) != 0)
-    need = calculate_tls_need(eh, htab);
+    need = calculate_tls_need(eh, info, htab);
   else
     need = GOT_ENTRY_SIZE;
   
@@ -2937,7 +4841,21 @@ allocate_got_entry(struct elf_link_hash_entry *h,
       s = htab->elf.sgot;
       h->got.offset = s->size;
       s->size += need;
-      htab->elf.srelgot->size += need * (RELA_SIZE / GOT_ENTRY_SIZE);
+      /* relocate_section and finish_dynamic_symbol make the same test
+         when choosing where the slot's relative reloc goes.  */
+      if ((eh->tls_mask & TLS_TLS) == 0
+          && microblaze_elf_use_relr(info, htab)
+          && get_symbol_index(info, h) == 0)
+        {
+          eh->got_rel_index = RELR_REL_INDEX;
+          htab->relr_alloc++;
+        }
+      else
+        {
+          eh->got_rel_index = htab->elf.srelgot->size / RELA_SIZE;
+          htab->elf.srelgot->size += (got_entry_reloc_count(eh, info, need)
+                                      * RELA_SIZE);
+        }
     }
   
   return true;
@@ -2948,7 +4866,11 @@ process_got_allocation(struct elf_link_hash_entry *h,
                        struct bfd_link_info *info,
                        struct elf32_mb_link_hash_table *htab)
 {
-  if (h->got.refcount > 0)
+  /* No slot is needed when relocate_section will turn every GOT load
+     of the symbol into GOTOFF addressing.  */
+  if (h->got.refcount > 0
+      && (h->got.refcount > elf32_mb_hash_entry(h)->gotoff_refcount
+          || !microblaze_gotoff_relaxable(info, h, false, true)))
     return allocate_got_entry(h, info, htab);
   else
     h->got.offset = INVALID_OFFSET;
@@ -3044,6 +4966,7 @@ allocate_dynreloc_space(struct elf_link_hash_entry *h)
   for (p = h->dyn_relocs; p != NULL; p = p->next)
     {
       asection *sreloc = elf_section_data(p->sec)->sreloc;
+      ((struct elf32_mb_dyn_relocs *) p)->rel_index = sreloc->size / RELA_SIZE;
       sreloc->size += p->count * RELA_SIZE;
     }
 }
@@ -3079,12 +5002,14 @@ allocate_dynrelocs(struct elf_link_hash_entry *h, void *dat)
 /* Set the sizes of the dynamic sections.  */
 
 static bool
-process_input_bfd_sections(bfd *ibfd, struct bfd_link_info *info)
+process_input_bfd_sections(bfd *ibfd, struct elf32_mb_link_hash_table *htab,
+                           struct bfd_link_info *info)
 {
     asection *s;
     
     for (s = ibfd->sections; s != NULL; s = s->next)
     {
+        struct _microblaze_elf_section_data *sdata;
         struct elf_dyn_relocs *p;
         
         for (p = ((struct elf_dyn_relocs *)
@@ -3092,22 +5017,36 @@ process_input_bfd_sections(bfd *ibfd, struct bfd_link_info *info)
              p != NULL;
              p = p->next)
         {
-            if (bfd_is_abs_section (p->sec)
-                && !bfd_is_abs_section (p->sec->output_section)
-                && p->count != 0)
+            if (!bfd_is_abs_section (p->sec)
+                && bfd_is_abs_section (p->sec->output_section))
+            {
+                /* The input section was discarded, and its relocs with
+                   it.  */
+            }
+            else if (p->count != 0)
             {
                 asection *srel = elf_section_data (p->sec)->sreloc;
+                ((struct elf32_mb_dyn_relocs *) p)->rel_index
+                  = srel->size / sizeof (Elf32_External_Rela);
                 srel->size += p->count * sizeof (Elf32_External_Rela);
                 if ((p->sec->output_section->flags & SEC_READONLY) != 0)
                     info->flags |= DF_TEXTREL;
             }
         }
+        
+        sdata = microblaze_elf_section_data (s);
+        if (sdata != NULL)
+            htab->relr_alloc += sdata->relr_count;
     }
     return true;
 }
 
+/* Return the GOT bytes a local symbol with GOT mask LGOT_MASK needs.
+   As for a global in calculate_tls_need, IE accesses that are all
+   relaxed to LE in an executable need no slot.  */
+
 static unsigned int
-calculate_tls_need(unsigned char lgot_mask)
+calculate_local_got_need(unsigned char lgot_mask, struct bfd_link_info *info)
 {
     unsigned int need = 0;
     
@@ -3115,6 +5054,11 @@ calculate_tls_need(unsigned char lgot_mask)
     {
         if ((lgot_mask & TLS_GD) != 0)
             need += 8;
+        if ((lgot_mask & TLS_TPREL) != 0
+            && ((lgot_mask & TLS_TPREL_NORELAX) != 0
+                || microblaze_tls_transition(info, R_MICROBLAZE_TLSGOTTPREL32,
+                                             NULL, true) != TLS_MODEL_LE))
+            need += 4;
     }
     else
     {
@@ -3126,6 +5070,7 @@ calculate_tls_need(unsigned char lgot_mask)
 
 static void
 process_local_got_entry(bfd_signed_vma *local_got, unsigned char lgot_mask,
+                       bfd_size_type *rel_index,
                        asection *s, asection *srel, 
                        struct elf32_mb_link_hash_table *htab,
                        struct bfd_link_info *info)
@@ -3136,7 +5081,7 @@ process_local_got_entry(bfd_signed_vma *local_got, unsigned char lgot_mask,
         return;
     }
     
-    unsigned int need = calculate_tls_need(lgot_mask);
+    unsigned int need = calculate_local_got_need(lgot_mask, info);
     
     if ((lgot_mask & TLS_TLS) != 0 && (lgot_mask & TLS_LD) != 0)
         htab->tlsld_got.refcount += 1;
@@ -3149,12 +5094,20 @@ process_local_got_entry(bfd_signed_vma *local_got, unsigned char lgot_mask,
     {
         *local_got = s->size;
         s->size += need;
-        if (bfd_link_pic (info))
+        if ((lgot_mask & TLS_TLS) == 0 && microblaze_elf_use_relr (info, htab))
+        {
+            *rel_index = RELR_REL_INDEX;
+            htab->relr_alloc++;
+        }
+        else if (bfd_link_pic (info))
+        {
+            *rel_index = srel->size / sizeof (Elf32_External_Rela);
             srel->size += need * (sizeof (Elf32_External_Rela) / 4);
+        }
     }
 }
 
-static void
+static bool
 process_local_got_offsets(bfd *ibfd, struct elf32_mb_link_hash_table *htab,
                          struct bfd_link_info *info)
 {
@@ -3163,11 +5116,12 @@ process_local_got_offsets(bfd *ibfd, struct elf32_mb_link_hash_table *htab,
     bfd_size_type locsymcount;
     Elf_Internal_Shdr *symtab_hdr;
     unsigned char *lgot_masks;
+    bfd_size_type *rel_index;
     asection *s, *srel;
     
     local_got = elf_local_got_refcounts (ibfd);
     if (!local_got)
-        return;
+        return true;
     
     symtab_hdr = &elf_tdata (ibfd)->symtab_hdr;
     locsymcount = symtab_hdr->sh_info;
@@ -3176,13 +5130,21 @@ process_local_got_offsets(bfd *ibfd, struct elf32_mb_link_hash_table *htab,
     s = htab->elf.sgot;
     srel = htab->elf.srelgot;
     
-    for (; local_got < end_local_got; ++local_got, ++lgot_masks)
+    rel_index = (bfd_size_type *) bfd_zalloc (ibfd, locsymcount
+                                              * sizeof (bfd_size_type));
+    if (rel_index == NULL)
+        return false;
+    elf32_mb_tdata (ibfd)->local_got_rel_index = rel_index;
+    
+    for (; local_got < end_local_got; ++local_got, ++lgot_masks, ++rel_index)
     {
-        process_local_got_entry(local_got, *lgot_masks, s, srel, htab, info);
+        process_local_got_entry(local_got, *lgot_masks, rel_index,
+                                s, srel, htab, info);
     }
+    return true;
 }
 
-static void
+static bool
 setup_local_syms_and_relocs(struct bfd_link_info *info,
                            struct elf32_mb_link_hash_table *htab)
 {
@@ -3190,12 +5152,17 @@ setup_local_syms_and_relocs(struct bfd_link_info *info,
     
     for (ibfd = info->input_bfds; ibfd != NULL; ibfd = ibfd->link.next)
     {
-        if (bfd_get_flavour (ibfd) != bfd_target_elf_flavour)
+        /* The section and tdata of other ELF targets' bfds do not have
+           our layout.  */
+        if (bfd_get_flavour (ibfd) != bfd_target_elf_flavour
+            || get_elf_backend_data (ibfd)->target_id != MICROBLAZE_ELF_DATA)
             continue;
         
-        process_input_bfd_sections(ibfd, info);
-        process_local_got_offsets(ibfd, htab, info);
+        process_input_bfd_sections(ibfd, htab, info);
+        if (!process_local_got_offsets(ibfd, htab, info))
+            return false;
     }
+    return true;
 }
 
 static void
@@ -3206,6 +5173,8 @@ allocate_tlsld_got(struct elf32_mb_link_hash_table *htab,
     {
         htab->tlsld_got.offset = htab->elf.sgot->size;
         htab->elf.sgot->size += 8;
+        htab->tlsld_got_rel_index = (htab->elf.srelgot->size
+                                     / sizeof (Elf32_External_Rela));
         if (bfd_link_pic (info))
             htab->elf.srelgot->size += sizeof (Elf32_External_Rela);
     }
@@ -3273,6 +5242,14 @@ allocate_dynamic_sections(bfd *dynobj, struct elf32_mb_link_hash_table *htab)
             }
             s->reloc_count = 0;
         }
+        else if (s == htab->elf.srelrdyn)
+        {
+            if (s->size == 0)
+            {
+                s->flags |= SEC_EXCLUDE;
+                continue;
+            }
+        }
         else if (!is_special_section(s, htab))
         {
             continue;
@@ -3285,6 +5262,31 @@ allocate_dynamic_sections(bfd *dynobj, struct elf32_mb_link_hash_table *htab)
     return true;
 }
 
+/* Size .relr.dyn for the worst case, a word for every relative reloc
+   counted by check_relocs and the GOT allocation, which is also what
+   its contents are allocated for.  Once the layout is known,
+   microblaze_elf_size_relative_relocs shrinks it to the encoding.  */
+
+static bool
+size_relr_section(struct elf32_mb_link_hash_table *htab)
+{
+    asection *srelr = htab->elf.srelrdyn;
+    
+    if (srelr == NULL)
+        return true;
+    
+    srelr->size = htab->relr_alloc * 4;
+    free (htab->relr);
+    htab->relr = NULL;
+    htab->relr_count = 0;
+    htab->relr_layout_passes = 0;
+    if (htab->relr_alloc == 0)
+        return true;
+    
+    htab->relr = (bfd_vma *) bfd_malloc (htab->relr_alloc * sizeof (bfd_vma));
+    return htab->relr != NULL;
+}
+
 static bool
 microblaze_elf_late_size_sections (bfd *output_bfd ATTRIBUTE_UNUSED,
                                   struct bfd_link_info *info)
@@ -3300,7 +5302,8 @@ microblaze_elf_late_size_sections (bfd *output_bfd ATTRIBUTE_UNUSED,
     if (dynobj == NULL)
         return true;
     
-    setup_local_syms_and_relocs(info, htab);
+    if (!setup_local_syms_and_relocs(info, htab))
+        return false;
     
     elf_link_hash_traverse (elf_hash_table (info), allocate_dynrelocs, info);
     
@@ -3308,10 +5311,14 @@ microblaze_elf_late_size_sections (bfd *output_bfd ATTRIBUTE_UNUSED,
     
     add_plt_trailing_nop(htab);
     
+    if (!size_relr_section(htab))
+        return false;
+    
     if (!allocate_dynamic_sections(dynobj, htab))
         return false;
     
-    info->flags |= DF_BIND_NOW;
+    if (!htab->params.lazy_plt)
+        info->flags |= DF_BIND_NOW;
     return _bfd_elf_add_dynamic_tags (output_bfd, info, true);
 }
 
@@ -3335,6 +5342,33 @@ fill_plt_entry(bfd *output_bfd, asection *splt, bfd_vma plt_offset,
                splt->contents + plt_offset + 12);
 }
 
+/* Fill in the lazy tail of the PLT entry at PLT_OFFSET, whose .got.plt
+   slot at GOT_OFFSET initially points at the tail so that the first
+   call goes through the resolver.  */
+
+static void
+fill_lazy_plt_tail(bfd *output_bfd, asection *splt, asection *sgotplt,
+                   bfd_vma plt_offset, bfd_vma got_offset, bfd_vma plt_index)
+{
+    bfd_vma tail = plt_offset + PLT_ENTRY_SIZE;
+    bfd_vma reloc_offset = plt_index * sizeof(Elf32_External_Rela);
+    /* The "bri" is relative to its own address; PLT0 is at offset 0.  */
+    bfd_vma disp = -(tail + 12);
+    bfd_byte *loc = splt->contents + tail;
+    
+    bfd_put_32(output_bfd, LAZY_PLT_ENTRY_WORD_4 + ((reloc_offset >> 16) & 0xffff),
+               loc);
+    bfd_put_32(output_bfd, LAZY_PLT_ENTRY_WORD_5 + (reloc_offset & 0xffff),
+               loc + 4);
+    bfd_put_32(output_bfd, LAZY_PLT_ENTRY_WORD_6 + ((disp >> 16) & 0xffff),
+               loc + 8);
+    bfd_put_32(output_bfd, LAZY_PLT_ENTRY_WORD_7 + (disp & 0xffff),
+               loc + 12);
+    
+    bfd_put_32(output_bfd, splt->output_section->vma + splt->output_offset + tail,
+               sgotplt->contents + got_offset);
+}
+
 static void
 create_plt_relocation(bfd *output_bfd, asection *sgotplt, asection *srela,
                      bfd_vma got_offset, bfd_vma plt_index, 
@@ -3366,7 +5400,7 @@ process_plt_entry(bfd *output_bfd, struct bfd_link_info *info,
     asection *sgotplt = htab->elf.sgotplt;
     BFD_ASSERT(splt != NULL && srela != NULL && sgotplt != NULL);
     
-    bfd_vma plt_index = h->plt.offset / PLT_ENTRY_SIZE - 1;
+    bfd_vma plt_index = h->plt.offset / plt_entry_size(htab) - 1;
     bfd_vma got_offset = (plt_index + 3) * 4;
     bfd_vma got_addr = got_offset;
     
@@ -3374,6 +5408,9 @@ process_plt_entry(bfd *output_bfd, struct bfd_link_info *info,
         got_addr += sgotplt->output_section->vma + sgotplt->output_offset;
     
     fill_plt_entry(output_bfd, splt, h->plt.offset, got_addr, bfd_link_pic(info));
+    if (htab->params.lazy_plt)
+        fill_lazy_plt_tail(output_bfd, splt, sgotplt, h->plt.offset,
+                           got_offset, plt_index);
     create_plt_relocation(output_bfd, sgotplt, srela, got_offset, plt_index, h);
     
     if (!h->def_regular) {
@@ -3413,29 +5450,33 @@ process_got_entry(bfd *output_bfd, struct bfd_link_info *info,
     if (h->got.offset == (bfd_vma) -1)
         return false;
         
-    if ((h->got.offset & 1) || IS_TLS_LD(eh->tls_mask) || IS_TLS_GD(eh->tls_mask))
+    if ((eh->tls_mask & TLS_TLS) != 0)
+        return false;
+    
+    /* relocate_section has stored the value of a symbol that binds
+       locally, and output its relative reloc if it needs one.  */
+    if (get_symbol_index(info, h) == 0)
         return false;
     
     asection *sgot = htab->elf.sgot;
     asection *srela = htab->elf.srelgot;
     BFD_ASSERT(sgot != NULL && srela != NULL);
     
-    bfd_vma offset = sgot->output_section->vma + sgot->output_offset + 
-                    (h->got.offset &~ (bfd_vma) 1);
+    bfd_vma got_off = h->got.offset & ~(bfd_vma) GOT_DONE_MASK;
+    bfd_vma offset = sgot->output_section->vma + sgot->output_offset + got_off;
     
     if (should_emit_relative_reloc(info, h)) {
         bfd_vma value = calculate_got_value(h);
         microblaze_elf_output_dynamic_relocation(output_bfd, srela, 
-                                                srela->reloc_count++, 0,
+                                                eh->got_rel_index, 0,
                                                 R_MICROBLAZE_REL, offset, value);
     } else {
         microblaze_elf_output_dynamic_relocation(output_bfd, srela,
-                                                srela->reloc_count++, h->dynindx,
+                                                eh->got_rel_index, h->dynindx,
                                                 R_MICROBLAZE_GLOB_DAT, offset, 0);
     }
     
-    bfd_put_32(output_bfd, (bfd_vma) 0, 
-              sgot->contents + (h->got.offset &~ (bfd_vma) 1));
+    bfd_put_32(output_bfd, (bfd_vma) 0, sgot->contents + got_off);
     
     return true;
 }
@@ -3514,6 +5555,16 @@ get_dynamic_section_info(Elf_Internal_Dyn *dyn, struct elf32_mb_link_hash_table
         *is_size = false;
         return true;
 
+    case DT_RELR:
+        *section = htab->elf.srelrdyn;
+        *is_size = false;
+        return true;
+
+    case DT_RELRSZ:
+        *section = htab->elf.srelrdyn;
+        *is_size = true;
+        return true;
+
     default:
         return false;
     }
@@ -3564,12 +5615,49 @@ process_dynamic_entries(bfd *output_bfd, bfd *dynobj, asection *sdyn,
 #define NOP_INSTRUCTION 0x80000000
 #define ENTSIZE_VALUE 4
 
+/* Fill in PLT0 of a lazy PLT: load the link map from .got.plt[1] into
+   r4 and jump to the resolver in .got.plt[2].  The entry's tail has
+   left the offset of its JUMP_SLOT reloc in r3.  */
+
+static void
+fill_lazy_plt0(bfd *output_bfd, asection *splt, asection *sgotplt, bool is_pic)
+{
+    bfd_vma got_addr = 0;
+    bfd_vma link_map, resolver;
+    
+    if (!is_pic)
+        got_addr = sgotplt->output_section->vma + sgotplt->output_offset;
+    link_map = got_addr + 4;
+    resolver = got_addr + 8;
+    
+    bfd_put_32(output_bfd, PLT_ENTRY_WORD_0 + ((link_map >> 16) & 0xffff),
+               splt->contents);
+    bfd_put_32(output_bfd, (is_pic ? LAZY_PLT0_WORD_1 : LAZY_PLT0_WORD_1_NOPIC)
+                           + (link_map & 0xffff),
+               splt->contents + 4);
+    bfd_put_32(output_bfd, PLT_ENTRY_WORD_0 + ((resolver >> 16) & 0xffff),
+               splt->contents + 8);
+    bfd_put_32(output_bfd, (is_pic ? LAZY_PLT0_WORD_3 : LAZY_PLT0_WORD_3_NOPIC)
+                           + (resolver & 0xffff),
+               splt->contents + 12);
+    bfd_put_32(output_bfd, (bfd_vma) PLT_ENTRY_WORD_2, splt->contents + 16);
+    bfd_put_32(output_bfd, (bfd_vma) PLT_ENTRY_WORD_3, splt->contents + 20);
+    bfd_put_32(output_bfd, (bfd_vma) PLT_ENTRY_WORD_3, splt->contents + 24);
+    bfd_put_32(output_bfd, (bfd_vma) PLT_ENTRY_WORD_3, splt->contents + 28);
+}
+
 static void
-initialize_plt_section(bfd *output_bfd, asection *splt)
+initialize_plt_section(bfd *output_bfd, struct bfd_link_info *info,
+                       struct elf32_mb_link_hash_table *htab)
 {
+    asection *splt = htab->elf.splt;
+    
     if (splt->size > 0)
     {
-        memset(splt->contents, 0, PLT_ENTRY_SIZE);
+        if (htab->params.lazy_plt)
+            fill_lazy_plt0(output_bfd, splt, htab->elf.sgotplt, bfd_link_pic(info));
+        else
+            memset(splt->contents, 0, PLT_ENTRY_SIZE);
         bfd_put_32(output_bfd, (bfd_vma) NOP_INSTRUCTION,
                   splt->contents + splt->size - 4);
 
@@ -3604,6 +5692,271 @@ set_section_entsize(asection *section)
     }
 }
 
+static int
+compare_relr_addresses(const void *a, const void *b)
+{
+    bfd_vma va = *(const bfd_vma *) a;
+    bfd_vma vb = *(const bfd_vma *) b;
+    
+    return va < vb ? -1 : va > vb;
+}
+
+static void
+microblaze_elf_collect_relr (struct elf32_mb_link_hash_table *htab,
+                             bfd_vma address)
+{
+    BFD_ASSERT (htab->relr_count < htab->relr_alloc);
+    if (htab->relr_count < htab->relr_alloc)
+        htab->relr[htab->relr_count++] = address;
+}
+
+/* Collect the address of the GOT entry of H if its relative reloc is
+   packed into .relr.dyn.  */
+
+static bool
+collect_relr_got_entry (struct elf_link_hash_entry *h, void *data)
+{
+    struct elf32_mb_link_hash_table *htab
+        = (struct elf32_mb_link_hash_table *) data;
+    asection *sgot = htab->elf.sgot;
+    
+    if (h->got.offset != (bfd_vma) -1
+        && elf32_mb_hash_entry (h)->got_rel_index == RELR_REL_INDEX)
+        microblaze_elf_collect_relr (htab, (sgot->output_section->vma
+                                            + sgot->output_offset
+                                            + (h->got.offset
+                                               & ~(bfd_vma) GOT_DONE_MASK)));
+    return true;
+}
+
+/* Collect the addresses of the .relr.dyn relocs of IBFD: the GOT
+   entries of its local symbols, and the R_MICROBLAZE_32 words that
+   relocate_section stores for output_relr_relocation.  The test applied
+   to each reloc must match the one relocate_section makes.  */
+
+static bool
+collect_relr_input_bfd (bfd *ibfd, struct bfd_link_info *info,
+                        struct elf32_mb_link_hash_table *htab)
+{
+    Elf_Internal_Shdr *symtab_hdr = &elf_tdata (ibfd)->symtab_hdr;
+    bfd_size_type *rel_index = elf32_mb_tdata (ibfd)->local_got_rel_index;
+    bfd_vma *local_got = elf_local_got_offsets (ibfd);
+    asection *sgot = htab->elf.sgot;
+    asection *s;
+    bfd_size_type i;
+    
+    if (rel_index != NULL && local_got != NULL)
+        for (i = 0; i < symtab_hdr->sh_info; i++)
+            if (rel_index[i] == RELR_REL_INDEX && local_got[i] != (bfd_vma) -1)
+                microblaze_elf_collect_relr (htab, (sgot->output_section->vma
+                                                    + sgot->output_offset
+                                                    + (local_got[i]
+                                                       & ~(bfd_vma) GOT_DONE_MASK)));
+    
+    for (s = ibfd->sections; s != NULL; s = s->next)
+    {
+        Elf_Internal_Rela *relocs, *rel, *relend;
+        bfd_vma limit;
+        
+        if (microblaze_elf_section_data (s)->relr_count == 0
+            || s->output_section == NULL
+            || bfd_is_abs_section (s->output_section))
+            continue;
+        
+        relocs = _bfd_elf_link_read_relocs (ibfd, s, NULL, NULL,
+                                            info->keep_memory);
+        if (relocs == NULL)
+            return false;
+        
+        limit = bfd_get_section_limit (ibfd, s);
+        relend = relocs + s->reloc_count;
+        for (rel = relocs; rel < relend; rel++)
+        {
+            unsigned long r_symndx = ELF32_R_SYM (rel->r_info);
+            bfd_vma offset;
+            
+            if (r_symndx == STN_UNDEF
+                || r_symndx >= symtab_hdr->sh_info
+                || rel->r_offset > limit
+                || !microblaze_elf_relr_reloc_p (info, htab, s,
+                                                 ELF32_R_TYPE (rel->r_info),
+                                                 rel->r_offset))
+                continue;
+            
+            offset = _bfd_elf_section_offset (info->output_bfd, info, s,
+                                              rel->r_offset);
+            if (offset == (bfd_vma) -1 || offset == (bfd_vma) -2)
+                continue;
+            
+            microblaze_elf_collect_relr (htab, (s->output_section->vma
+                                                + s->output_offset + offset));
+        }
+        
+        if (elf_section_data (s)->relocs != relocs)
+            free (relocs);
+    }
+    
+    return true;
+}
+
+/* Collect, sort and deduplicate the addresses of every .relr.dyn reloc
+   for the current layout.  */
+
+static bool
+collect_relr_addresses (struct bfd_link_info *info,
+                        struct elf32_mb_link_hash_table *htab)
+{
+    bfd *ibfd;
+    bfd_size_type i, j;
+    
+    htab->relr_count = 0;
+    if (htab->relr == NULL)
+        return true;
+    
+    elf_link_hash_traverse (&htab->elf, collect_relr_got_entry, htab);
+    
+    for (ibfd = info->input_bfds; ibfd != NULL; ibfd = ibfd->link.next)
+        if (bfd_get_flavour (ibfd) == bfd_target_elf_flavour
+            && get_elf_backend_data (ibfd)->target_id == MICROBLAZE_ELF_DATA
+            && !collect_relr_input_bfd (ibfd, info, htab))
+            return false;
+    
+    if (htab->relr_count > 1)
+    {
+        qsort (htab->relr, htab->relr_count, sizeof (bfd_vma),
+               compare_relr_addresses);
+        for (i = 1, j = 1; i < htab->relr_count; i++)
+            if (htab->relr[i] != htab->relr[j - 1])
+                htab->relr[j++] = htab->relr[i];
+        htab->relr_count = j;
+    }
+    
+    return true;
+}
+
+/* Encode the N sorted addresses ADDR for .relr.dyn at LOC, or only
+   count the words if LOC is NULL.  Each address entry is followed by
+   bitmap entries, with the low bit set, for the next 31 words each.
+   Return the size of the encoding in bytes.  */
+
+static bfd_size_type
+encode_relr (bfd *output_bfd, const bfd_vma *addr, bfd_size_type n,
+             bfd_byte *loc)
+{
+    bfd_size_type i, words = 0;
+    
+    for (i = 0; i < n;)
+    {
+        bfd_vma base = addr[i++];
+        
+        if (loc != NULL)
+            bfd_put_32 (output_bfd, base, loc + words * 4);
+        words++;
+        base += 4;
+        for (;;)
+        {
+            bfd_vma bitmap = 0;
+            
+            while (i < n && addr[i] - base < 31 * 4)
+            {
+                bitmap |= (bfd_vma) 1 << ((addr[i] - base) / 4);
+                i++;
+            }
+            if (bitmap == 0)
+                break;
+            if (loc != NULL)
+                bfd_put_32 (output_bfd, (bitmap << 1) | 1, loc + words * 4);
+            words++;
+            base += 31 * 4;
+        }
+    }
+    
+    return words * 4;
+}
+
+/* Give up shrinking .relr.dyn after this many layouts, in case moving
+   the sections after it keeps changing the encoding; from then on it
+   only grows, and any slack is filled with empty bitmaps.  */
+#define RELR_MAX_SHRINK_PASSES 4
+
+/* Size .relr.dyn to the encoding of its relocs in the current layout,
+   asking for another layout if that changed its size.  */
+
+static bool
+microblaze_elf_size_relative_relocs (struct bfd_link_info *info,
+                                     bool *need_layout)
+{
+    struct elf32_mb_link_hash_table *htab = elf32_mb_hash_table (info);
+    asection *srelr;
+    bfd_size_type size;
+    
+    *need_layout = false;
+    if (htab == NULL)
+        return false;
+    
+    srelr = htab->elf.srelrdyn;
+    if (!microblaze_elf_use_relr (info, htab)
+        || srelr->size == 0 || (srelr->flags & SEC_EXCLUDE) != 0)
+        return true;
+    
+    if (!collect_relr_addresses (info, htab))
+        return false;
+    
+    size = encode_relr (info->output_bfd, htab->relr, htab->relr_count, NULL);
+    if (size < srelr->size
+        && htab->relr_layout_passes >= RELR_MAX_SHRINK_PASSES)
+        size = srelr->size;
+    
+    if (size != srelr->size)
+    {
+        srelr->size = size;
+        htab->relr_layout_passes++;
+        *need_layout = true;
+    }
+    return true;
+}
+
+/* Write .relr.dyn for the final layout.  */
+
+static bool
+microblaze_elf_finish_relative_relocs (struct bfd_link_info *info)
+{
+    struct elf32_mb_link_hash_table *htab = elf32_mb_hash_table (info);
+    asection *srelr;
+    bfd_size_type size;
+    bfd_byte *loc;
+    
+    if (htab == NULL)
+        return false;
+    
+    srelr = htab->elf.srelrdyn;
+    if (!microblaze_elf_use_relr (info, htab)
+        || srelr->size == 0 || (srelr->flags & SEC_EXCLUDE) != 0)
+        return true;
+    
+    if (!collect_relr_addresses (info, htab))
+        return false;
+    
+    size = encode_relr (info->output_bfd, htab->relr, htab->relr_count, NULL);
+    if (size > srelr->size)
+    {
+        _bfd_error_handler (_("%pB: .relr.dyn is too small for its relocs"),
+                            info->output_bfd);
+        bfd_set_error (bfd_error_bad_value);
+        return false;
+    }
+    
+    encode_relr (info->output_bfd, htab->relr, htab->relr_count,
+                 srelr->contents);
+    for (loc = srelr->contents + size; loc < srelr->contents + srelr->size;
+         loc += 4)
+        bfd_put_32 (info->output_bfd, 1, loc);
+    
+    free (htab->relr);
+    htab->relr = NULL;
+    return true;
+}
+
 static bool
 microblaze_elf_finish_dynamic_sections(bfd *output_bfd,
                                        struct bfd_link_info *info)
@@ -3622,7 +5975,7 @@ microblaze_elf_finish_dynamic_sections(bfd *output_bfd,
         asection *splt = htab->elf.splt;
         BFD_ASSERT(splt != NULL && sdyn != NULL);
         
-        initialize_plt_section(output_bfd, splt);
+        initialize_plt_section(output_bfd, info, htab);
     }
 
     initialize_got_section(output_bfd, htab->elf.sgotplt, sdyn);
@@ -3674,6 +6027,143 @@ microblaze_elf_add_symbol_hook(bfd *abfd,
     return true;
 }
 
+/* Classify dynamic relocs so that the generic linker can sort relative
+   relocs to the front of .rela.dyn and emit DT_RELACOUNT.  */
+
+static enum elf_reloc_type_class
+microblaze_elf_reloc_type_class(const struct bfd_link_info *info ATTRIBUTE_UNUSED,
+                                const asection *rel_sec ATTRIBUTE_UNUSED,
+                                const Elf_Internal_Rela *rela)
+{
+    switch ((int) ELF32_R_TYPE(rela->r_info))
+    {
+    case R_MICROBLAZE_REL:
+        return reloc_class_relative;
+    case R_MICROBLAZE_JUMP_SLOT:
+        return reloc_class_plt;
+    case R_MICROBLAZE_COPY:
+        return reloc_class_copy;
+    default:
+        return reloc_class_normal;
+    }
+}
+
+/* Write the relaxation report asked for by the linker emulation: one
+   line per MicroBlaze input section that relaxation looked at, then a
+   line for the whole link.  Fields are key=value pairs so that the
+   report can be read by scripts.  */
+
+static void
+microblaze_elf_report_relax_stats (struct bfd_link_info *info,
+				   struct elf32_mb_link_hash_table *htab)
+{
+  FILE *f = htab->params.relax_stats;
+  struct microblaze_relax_stats total;
+  unsigned long sections = 0;
+  bfd *ibfd;
+
+  memset (&total, 0, sizeof (total));
+  for (ibfd = info->input_bfds; ibfd != NULL; ibfd = ibfd->link.next)
+    {
+      asection *sec;
+
+      if (bfd_get_flavour (ibfd) != bfd_target_elf_flavour
+	  || get_elf_backend_data (ibfd)->target_id != MICROBLAZE_ELF_DATA)
+	continue;
+
+      for (sec = ibfd->sections; sec != NULL; sec = sec->next)
+	{
+	  struct microblaze_relax_stats *st;
+
+	  if (elf_section_data (sec) == NULL)
+	    continue;
+	  st = &microblaze_elf_section_data (sec)->relax_stats;
+	  if (st->calls == 0)
+	    continue;
+
+	  fprintf (f, "microblaze-relax section=%s:%s calls=%lu rounds=%lu"
+		   " imm-deleted=%lu bytes-saved=%lu relocs-rewritten=%lu"
+		   " other-relocs-patched=%lu scan-us=%ld delete-us=%ld\n",
+		   bfd_get_filename (ibfd), sec->name, st->calls, st->rounds,
+		   st->imm_deleted, st->bytes_saved, st->relocs_rewritten,
+		   st->other_relocs_patched, st->scan_time, st->delete_time);
+
+	  sections++;
+	  total.rounds += st->rounds;
+	  total.imm_deleted += st->imm_deleted;
+	  total.bytes_saved += st->bytes_saved;
+	  total.relocs_rewritten += st->relocs_rewritten;
+	  total.other_relocs_patched += st->other_relocs_patched;
+	  total.scan_time += st->scan_time;
+	  total.delete_time += st->delete_time;
+	}
+    }
+
+  fprintf (f, "microblaze-relax link sections=%lu calls=%lu skipped=%lu"
+	   " rounds=%lu imm-deleted=%lu bytes-saved=%lu relocs-rewritten=%lu"
+	   " other-relocs-patched=%lu scan-us=%ld delete-us=%ld"
+	   " relax-table-entries=%lu relax-table-grows=%lu\n",
+	   sections, htab->relax_calls, htab->relax_skipped, total.rounds,
+	   total.imm_deleted, total.bytes_saved, total.relocs_rewritten,
+	   total.other_relocs_patched, total.scan_time, total.delete_time,
+	   (unsigned long) htab->relax_buf_alloc, htab->relax_buf_grows);
+}
+
+/* Release the section contents that relaxation read and left cached
+   on the objects of the link INFO.  They may be private mappings of the
+   input file rather than malloced copies, so they go back through
+   _bfd_elf_munmap_section_contents, which knows which they are.  That
+   keeps contents that are still cached on the section, so they are
+   uncached first.  Contents cached by anyone else are left alone.  */
+
+static void
+microblaze_elf_release_relaxed_contents (struct bfd_link_info *info)
+{
+  bfd *ibfd;
+
+  for (ibfd = info->input_bfds; ibfd != NULL; ibfd = ibfd->link.next)
+    {
+      asection *sec;
+
+      if (bfd_get_flavour (ibfd) != bfd_target_elf_flavour
+	  || get_elf_backend_data (ibfd)->target_id != MICROBLAZE_ELF_DATA)
+	continue;
+
+      for (sec = ibfd->sections; sec != NULL; sec = sec->next)
+	{
+	  struct _microblaze_elf_section_data *sdata
+	    = microblaze_elf_section_data (sec);
+	  bfd_byte *contents;
+
+	  if (sdata == NULL || !sdata->relax_contents_cached)
+	    continue;
+
+	  contents = sdata->elf.this_hdr.contents;
+	  sdata->elf.this_hdr.contents = NULL;
+	  sdata->relax_contents_cached = false;
+	  _bfd_elf_munmap_section_contents (sec, contents);
+	}
+    }
+}
+
+/* Do the final link, then report on relaxation if asked to.  */
+
+static bool
+microblaze_elf_final_link (bfd *abfd, struct bfd_link_info *info)
+{
+  struct elf32_mb_link_hash_table *htab;
+
+  if (!bfd_elf_final_link (abfd, info))
+    return false;
+
+  htab = elf32_mb_hash_table (info);
+  if (htab != NULL && htab->params.relax_stats != NULL)
+    microblaze_elf_report_relax_stats (info, htab);
+
+  microblaze_elf_release_relaxed_contents (info);
+  return true;
+}
+
 #define TARGET_LITTLE_SYM      microblaze_elf32_le_vec
 #define TARGET_LITTLE_NAME     "elf32-microblazeel"
 
@@ -3691,12 +6181,15 @@ microblaze_elf_add_symbol_hook(bfd *abfd,
 #define bfd_elf32_bfd_reloc_type_lookup		microblaze_elf_reloc_type_lookup
 #define bfd_elf32_bfd_is_local_label_name	microblaze_elf_is_local_label_name
 #define bfd_elf32_new_section_hook		microblaze_elf_new_section_hook
+#define bfd_elf32_mkobject			microblaze_elf_mkobject
 #define elf_backend_relocate_section		microblaze_elf_relocate_section
 #define bfd_elf32_bfd_relax_section		microblaze_elf_relax_section
 #define bfd_elf32_bfd_merge_private_bfd_data	_bfd_generic_verify_endian_match
 #define bfd_elf32_bfd_reloc_name_lookup		microblaze_elf_reloc_name_lookup
+#define bfd_elf32_bfd_final_link		microblaze_elf_final_link
 
 #define elf_backend_gc_mark_hook		microblaze_elf_gc_mark_hook
+#define elf_backend_check_directives		microblaze_elf_before_check_relocs
 #define elf_backend_check_relocs		microblaze_elf_check_relocs
 #define elf_backend_copy_indirect_symbol	microblaze_elf_copy_indirect_symbol
 #define bfd_elf32_bfd_link_hash_table_create	microblaze_elf_link_hash_table_create
@@ -3708,12 +6201,16 @@ microblaze_elf_add_symbol_hook(bfd *abfd,
 #define elf_backend_want_dynrelro		1
 #define elf_backend_rela_normal			1
 #define elf_backend_dtrel_excludes_plt		1
+#define elf_backend_use_mmap			true
 
 #define elf_backend_adjust_dynamic_symbol	microblaze_elf_adjust_dynamic_symbol
 #define elf_backend_create_dynamic_sections	_bfd_elf_create_dynamic_sections
 #define elf_backend_finish_dynamic_sections	microblaze_elf_finish_dynamic_sections
 #define elf_backend_finish_dynamic_symbol	microblaze_elf_finish_dynamic_symbol
 #define elf_backend_late_size_sections		microblaze_elf_late_size_sections
+#define elf_backend_size_relative_relocs	microblaze_elf_size_relative_relocs
+#define elf_backend_finish_relative_relocs	microblaze_elf_finish_relative_relocs
 #define elf_backend_add_symbol_hook		microblaze_elf_add_symbol_hook
+#define elf_backend_reloc_type_class		microblaze_elf_reloc_type_class
 
 #include "elf32-target.h"